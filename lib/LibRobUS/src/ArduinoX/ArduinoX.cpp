@@ -7,14 +7,16 @@ Class to interface some of the ArduinoX "on board" functionnalities
 
 #include "ArduinoX.h"
 
-void ArduinoX::init(){
+void ArduinoX::init(uint16_t motorPwm){
   pinMode(BUZZER_PIN, OUTPUT);
   digitalWrite(BUZZER_PIN, LOW);
   pinMode(LOWBAT_PIN, INPUT);
   ina219.begin();
   for(uint8_t id = 0; id < 2; id++){
-    __motor__[id].init(MOTOR_PWM_PIN[id], MOTOR_DIR_PIN[id]);
+    __motor__[id].init(MOTOR_PWM_PIN[id], MOTOR_DIR_PIN[id], motorPwm);
     __encoder__[id].init(COUNTER_SLAVE_PIN[id], COUNTER_FLAG_PIN[id]);
+    // Deltas count from here, whatever the counter holds
+    delta_[id].start(readCounter(id));
   }
 }
 
@@ -55,14 +57,19 @@ bool ArduinoX::isLowBat(){
 }
 
 void ArduinoX::setSpeedMotor(uint8_t id, float speed){
+  setDutyMotor(id, MotorControl::speedToDuty(speed));
+}
+
+void ArduinoX::setDutyMotor(uint8_t id, int16_t duty){
   if(id<0 || id>1){
     Serial.println("Invalid motor id!");
     return;
   }
-  if(id==1){
-    speed *= -1; // left motor is inverted
+  if(controlInterrupt_){
+    commands_.post(id, duty); // Applied by the next interrupt
+    return;
   }
-  __motor__[id].setSpeed(speed);
+  applyDuty(id, duty);
 }
 
 int32_t ArduinoX::readEncoder(uint8_t id){
@@ -70,11 +77,12 @@ int32_t ArduinoX::readEncoder(uint8_t id){
     Serial.println("Invalid encoder id!");
     return 0;
   }
-  if(id == 0){
-    return -__encoder__[id].read();// Left motor is inverted
-  }else{
-    return __encoder__[id].read();
+  if(controlInterrupt_){
+    EncoderSample sample;
+    readEncoderSample(sample);
+    return sample.count[id];
   }
+  return readCounter(id) - encoderOffset_[id];
 }
 
 int32_t ArduinoX::readResetEncoder(uint8_t id){
@@ -82,11 +90,17 @@ int32_t ArduinoX::readResetEncoder(uint8_t id){
     Serial.println("Invalid encoder id!");
     return 0;
   }
-  if(id == 0){
-    return -__encoder__[id].readReset();// Left motor is inverted
-  }else{
-    return __encoder__[id].readReset();
+  if(controlInterrupt_){
+    EncoderSample sample;
+    samples_.read(sample);
+    int32_t count = sample.count[id] - encoderOffset_[id];
+    encoderOffset_[id] = sample.count[id];
+    return count;
   }
+  int32_t raw = readCounter(id);
+  int32_t count = raw - encoderOffset_[id];
+  resetCounter(id, raw);
+  return count;
 }
 
 void ArduinoX::resetEncoder(uint8_t id){
@@ -94,5 +108,191 @@ void ArduinoX::resetEncoder(uint8_t id){
     Serial.println("Invalid encoder id!");
     return;
   }
+  if(controlInterrupt_){
+    // The interrupt owns the SPI counters, the reset is kept as an offset
+    EncoderSample sample;
+    samples_.read(sample);
+    encoderOffset_[id] = sample.count[id];
+    return;
+  }
+  resetCounter(id, readCounter(id));
+}
+
+int32_t ArduinoX::readDeltaEncoder(uint8_t id){
+  if(id<0 || id>1){
+    Serial.println("Invalid encoder id!");
+    return 0;
+  }
+  // Offsets are left out, a delta does not depend on resets
+  if(controlInterrupt_){
+    EncoderSample sample;
+    samples_.read(sample);
+    return delta_[id].update(sample.count[id]);
+  }
+  return delta_[id].update(readCounter(id));
+}
+
+uint32_t ArduinoX::enableControlInterrupt(uint32_t period){
+  // Timer 3 makes the PWM of the RIGHT motor, it overflows once per PWM period
+  uint32_t overflowCycles = __motor__[RIGHT].getPeriodCycles();
+  if(controlInterrupt_){
+    return divider_ * overflowCycles / clockCyclesPerMicrosecond();
+  }
+  uint32_t divider = (period * clockCyclesPerMicrosecond() + overflowCycles / 2) / overflowCycles;
+  // With the fast PWM modes, one period is shorter than the handler itself
+  uint32_t minDivider = (CONTROL_MIN_PERIOD * clockCyclesPerMicrosecond() + overflowCycles - 1) / overflowCycles;
+  if(divider < minDivider){
+    divider = minDivider;
+  }
+  divider_ = (divider < 1) ? 1 : (divider > 255) ? 255 : divider;
+  ticks_ = 0;
+
+  // First sample, so reads are valid before the first interrupt
+  int32_t count[2];
+  uint32_t time;
+  sampleCounters(count, time);
+  samples_.publish(count, time);
+
+  controlInterrupt_ = true;
+  TIFR3 = _BV(TOV3);      // clear any pending overflow
+  if(spiLocks_ == 0){
+    TIMSK3 |= _BV(TOIE3); // enable the overflow interrupt
+  }
+
+  return divider_ * overflowCycles / clockCyclesPerMicrosecond();
+}
+
+void ArduinoX::disableControlInterrupt(){
+  if(!controlInterrupt_){
+    return;
+  }
+  TIMSK3 &= ~_BV(TOIE3);
+  controlInterrupt_ = false;
+
+  // Apply a command posted after the last interrupt
+  MotorCommand command;
+  if(commands_.take(command)){
+    applyDuty(LEFT, command.duty[LEFT]);
+    applyDuty(RIGHT, command.duty[RIGHT]);
+  }
+}
+
+bool ArduinoX::isControlInterruptEnabled(){
+  return controlInterrupt_;
+}
+
+void ArduinoX::readEncoderSample(EncoderSample& sample){
+  if(controlInterrupt_){
+    samples_.read(sample);
+  }else{
+    sampleCounters(sample.count, sample.time);
+    sample.sequence = 0;
+  }
+  sample.count[LEFT] -= encoderOffset_[LEFT];
+  sample.count[RIGHT] -= encoderOffset_[RIGHT];
+}
+
+void ArduinoX::shareSPI(uint8_t csPin){
+  if(sharedCount_ >= CONTROL_SHARED_SPI){
+    Serial.println("Too many SPI devices!");
+    return;
+  }
+  // Deselected until its library starts it, so the bus does not read as busy
+  pinMode(csPin, OUTPUT);
+  digitalWrite(csPin, HIGH);
+  sharedPort_[sharedCount_] = portOutputRegister(digitalPinToPort(csPin));
+  sharedMask_[sharedCount_] = digitalPinToBitMask(csPin);
+  sharedCount_++;
+}
+
+void ArduinoX::lockSPI(){
+  if(spiLocks_++ == 0){
+    TIMSK3 &= ~_BV(TOIE3);
+  }
+}
+
+void ArduinoX::unlockSPI(){
+  if(spiLocks_ == 0){
+    return;
+  }
+  // An overflow that happened meanwhile is still pending and runs right away
+  if(--spiLocks_ == 0 && controlInterrupt_){
+    TIMSK3 |= _BV(TOIE3);
+  }
+}
+
+void ArduinoX::handleControlInterrupt(){
+  // The interrupt is ISR_NOBLOCK, so an overflow during a sample nests here
+  if(!controlInterrupt_ || inControl_){
+    return;
+  }
+  inControl_ = true;
+  if(ticks_ < divider_){
+    ticks_++;
+  }
+  // While another device has the bus, the sample waits for the next overflow
+  if(ticks_ < divider_ || isSPIBusy()){
+    inControl_ = false;
+    return;
+  }
+  ticks_ = 0;
+
+  // The counters use the settings of SPI.begin(), whatever settings the
+  // interrupted code chose for its own device
+  uint8_t spcr = SPCR;
+  uint8_t spsr = SPSR;
+  SPCR = _BV(SPE) | _BV(MSTR);
+  SPSR = 0;
+
+  int32_t count[2];
+  uint32_t time;
+  sampleCounters(count, time);
+
+  SPCR = spcr;
+  SPSR = spsr & _BV(SPI2X);
+  samples_.publish(count, time);
+
+  MotorCommand command;
+  if(commands_.take(command)){
+    applyDuty(LEFT, command.duty[LEFT]);
+    applyDuty(RIGHT, command.duty[RIGHT]);
+  }
+  inControl_ = false;
+}
+
+int32_t ArduinoX::readCounter(uint8_t id){
+  if(id == 0){
+    return -__encoder__[id].read();// Left motor is inverted
+  }else{
+    return __encoder__[id].read();
+  }
+}
+
+bool ArduinoX::isSPIBusy(){
+  for(uint8_t i = 0; i < sharedCount_; i++){
+    if((*sharedPort_[i] & sharedMask_[i]) == 0){
+      return true;
+    }
+  }
+  return false;
+}
+
+void ArduinoX::sampleCounters(int32_t count[2], uint32_t& time){
+  time = micros();
+  LS7366Counter::latch(__encoder__, 2);
+  count[LEFT] = -__encoder__[LEFT].readLatched();// Left motor is inverted
+  count[RIGHT] = __encoder__[RIGHT].readLatched();
+}
+
+void ArduinoX::resetCounter(uint8_t id, int32_t count){
   __encoder__[id].reset();// Reset counter
+  encoderOffset_[id] = 0;
+  delta_[id].rebase(count, 0);
+}
+
+void ArduinoX::applyDuty(uint8_t id, int16_t duty){
+  if(id==1){
+    duty = -duty; // left motor is inverted
+  }
+  __motor__[id].setDuty(duty);
 }
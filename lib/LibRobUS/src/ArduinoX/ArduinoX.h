@@ -12,15 +12,33 @@ Class to interface some of the ArduinoX "on board" functionnalities
 #include <Adafruit_INA219/Adafruit_INA219.h> // For power usage statistics
 #include <MotorControl/MotorControl.h>
 #include <LS7366Counter/LS7366Counter.h>
+#include <ControlMailbox/ControlMailbox.h>
+#include <EncoderDelta/EncoderDelta.h>
 
 #define LEFT 0
 #define RIGHT 1
+
+// Shortest time between two control samples (us), well above the ~50 us the
+// handler takes to read both counters, so a sample always ends before the next
+#ifndef CONTROL_MIN_PERIOD
+#define CONTROL_MIN_PERIOD 200
+#endif
+
+// Number of other devices sharing the SPI bus with the encoders
+#ifndef CONTROL_SHARED_SPI
+#define CONTROL_SHARED_SPI 2
+#endif
+
 class ArduinoX
 {
   public:
     /** Method to initialize pins and objects
+
+    @param motorPwm
+    PWM of the motors, MOTOR_PWM_ARDUINO or the TOP of their timers
+    (see MotorControl::init)
     */
-    void init();
+    void init(uint16_t motorPwm = MOTOR_PWM_ARDUINO);
 
     /** Method to turn on the buzzer
     */
@@ -79,6 +97,17 @@ class ArduinoX
     */
     void setSpeedMotor(uint8_t id, float speed);
 
+    /** Method to set speed (direction and pwm) to a motor drive
+     * without any floating point operation
+    
+    @param id
+    identification of motor [0,1]
+    
+    @param duty
+    duty to send to the drive [-MOTOR_DUTY_MAX, MOTOR_DUTY_MAX]
+    */
+    void setDutyMotor(uint8_t id, int16_t duty);
+
     /** Method read the count of pulses from a quadrature encoder
     
     @param id
@@ -105,6 +134,73 @@ class ArduinoX
     */
     void resetEncoder(uint8_t id);
 
+    /** Method read the number of pulses since the previous call, without
+     * resetting the counter, so no pulse is lost between two calls
+
+    @param id
+    identification of encoder [0,1]
+
+    @return number of pulses since the previous call
+    */
+    int32_t readDeltaEncoder(uint8_t id);
+
+    /** Method to read the encoders and drive the motors from the timer 3
+     * overflow interrupt instead of the calling code.
+     * Motor speeds are then applied on the next interrupt and encoder counts
+     * are the ones read by the last interrupt.
+
+    @param period
+    wanted time between two interrupts in microseconds, rounded to a
+    number of PWM periods of timer 3 [1, 255], and no shorter than
+    CONTROL_MIN_PERIOD
+
+    @return actual time between two interrupts in microseconds
+    */
+    uint32_t enableControlInterrupt(uint32_t period);
+
+    /** Method to go back to reading the encoders and driving the motors
+     * from the calling code
+    */
+    void disableControlInterrupt();
+
+    /** Method to know if the control interrupt is enabled
+
+    @return true, if the control interrupt is enabled. Else false.
+    */
+    bool isControlInterruptEnabled();
+
+    /** Method to read both encoders as they were at nearly the same instant.
+     * Both counters are latched back to back, then read one after the other.
+
+    @param sample
+    receives the counts of both encoders, the time they were read and
+    the number of samples taken so far
+    */
+    void readEncoderSample(EncoderSample& sample);
+
+    /** Method to name the chip select of another device on the SPI bus,
+     * such as the SD card. The control interrupt leaves the bus alone while
+     * that device is selected and takes its sample on a later overflow.
+
+    @param csPin
+    chip select pin of the device, driven LOW while it is selected
+    */
+    void shareSPI(uint8_t csPin);
+
+    /** Method to keep the control interrupt off the SPI bus during
+     * transfers made with no chip select LOW, such as the clocks that wake
+     * up an SD card. Calls nest, each one ends with unlockSPI().
+    */
+    void lockSPI();
+
+    /** Method to give the SPI bus back to the control interrupt
+    */
+    void unlockSPI();
+
+    /** Method called by the timer 3 overflow interrupt
+    */
+    void handleControlInterrupt();
+
   private:
     const uint8_t LOWBAT_PIN =  12;
     const uint8_t BUZZER_PIN =  36;
@@ -116,5 +212,24 @@ class ArduinoX
     MotorControl __motor__[2];
     LS7366Counter __encoder__[2];
 
+    SampleMailbox samples_;
+    CommandMailbox commands_;
+    volatile bool controlInterrupt_ = false;
+    uint8_t divider_ = 1;
+    uint8_t ticks_ = 0;
+    volatile bool inControl_ = false; // the handler is running, a nested overflow returns at once
+    int32_t encoderOffset_[2] = {0, 0}; // Counts at the last reset done while the interrupt owns the encoders
+    volatile uint8_t* sharedPort_[CONTROL_SHARED_SPI]; // output registers of the chip selects of shareSPI()
+    uint8_t sharedMask_[CONTROL_SHARED_SPI];
+    uint8_t sharedCount_ = 0;
+    uint8_t spiLocks_ = 0;
+    EncoderDelta delta_[2];
+
+    int32_t readCounter(uint8_t id);
+    bool isSPIBusy();
+    void sampleCounters(int32_t count[2], uint32_t& time);
+    void resetCounter(uint8_t id, int32_t count);
+    void applyDuty(uint8_t id, int16_t duty);
+
 };
 #endif //ArduinoX
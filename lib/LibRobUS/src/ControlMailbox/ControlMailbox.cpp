@@ -0,0 +1,44 @@
+/*
+Lock-free mailboxes between the control interrupt and the foreground code
+*/
+#include "ControlMailbox.h"
+
+void SampleMailbox::publish(const int32_t count[2], uint32_t time) {
+  version_++;
+  count_[0] = count[0];
+  count_[1] = count[1];
+  time_ = time;
+  sequence_++;
+  version_++;
+}
+
+void SampleMailbox::read(EncoderSample& sample) const {
+  uint8_t version;
+  do {
+    version = version_;
+    sample.count[0] = count_[0];
+    sample.count[1] = count_[1];
+    sample.time = time_;
+    sample.sequence = sequence_;
+  } while (version != version_);
+}
+
+void CommandMailbox::post(uint8_t id, int16_t duty) {
+  uint8_t next = 1 - current_;
+  slots_[next][0] = slots_[current_][0];
+  slots_[next][1] = slots_[current_][1];
+  slots_[next][id] = duty;
+  current_ = next;
+  posted_++;
+}
+
+bool CommandMailbox::take(MotorCommand& command) {
+  uint8_t posted = posted_;
+  if (posted == taken_) {
+    return false;
+  }
+  taken_ = posted;
+  command.duty[0] = slots_[current_][0];
+  command.duty[1] = slots_[current_][1];
+  return true;
+}
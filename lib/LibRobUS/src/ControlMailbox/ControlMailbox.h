@@ -0,0 +1,94 @@
+/*
+Lock-free mailboxes between the control interrupt and the foreground code
+Each mailbox has a single producer and a single consumer, one of them being
+the interrupt. The interrupt never waits on the foreground.
+*/
+#ifndef ControlMailbox_H_
+#define ControlMailbox_H_
+
+#include <Arduino.h>
+
+/** Counts of both encoders, latched a few microseconds apart
+*/
+struct EncoderSample
+{
+  int32_t count[2];
+  uint32_t time;      // micros() when the encoders were latched
+  uint32_t sequence;  // number of samples published, this one included
+};
+
+/** Duties of both motors, as given to MOTOR_SetDuty
+*/
+struct MotorCommand
+{
+  int16_t duty[2];
+};
+
+/** Mailbox from the interrupt to the foreground, holding the latest sample
+
+The interrupt bumps a version number around each write. The foreground
+copies the sample and starts over if the version moved meanwhile, which
+only happens if the interrupt fired during the copy.
+*/
+class SampleMailbox
+{
+  public:
+    /** Method to publish a sample, only from the interrupt
+
+    @param count
+    counts of the LEFT and RIGHT encoders
+
+    @param time
+    micros() when the encoders were read
+    */
+    void publish(const int32_t count[2], uint32_t time);
+
+    /** Method to copy the latest sample, only from the foreground
+
+    @param sample
+    receives the sample
+    */
+    void read(EncoderSample& sample) const;
+
+  private:
+    volatile uint8_t version_ = 0;
+    volatile int32_t count_[2] = {0, 0};
+    volatile uint32_t time_ = 0;
+    volatile uint32_t sequence_ = 0;
+};
+
+/** Mailbox from the foreground to the interrupt, holding the latest motor command
+
+The foreground writes the slot the interrupt is not reading, then switches
+the current slot with a single byte store. Each side only writes its own
+counter, so the interrupt knows when a new command is there.
+*/
+class CommandMailbox
+{
+  public:
+    /** Method to post the duty of one motor, only from the foreground
+
+    @param id
+    identification of the motor [0,1]
+
+    @param duty
+    duty to send to the drive [-MOTOR_DUTY_MAX, MOTOR_DUTY_MAX]
+    */
+    void post(uint8_t id, int16_t duty);
+
+    /** Method to take the latest command, only from the interrupt
+
+    @param command
+    receives the command
+
+    @return true if a command was posted since the last take, else false
+    */
+    bool take(MotorCommand& command);
+
+  private:
+    volatile int16_t slots_[2][2] = {{0, 0}, {0, 0}};
+    volatile uint8_t current_ = 0;
+    volatile uint8_t posted_ = 0;
+    uint8_t taken_ = 0;
+};
+#endif //ControlMailbox
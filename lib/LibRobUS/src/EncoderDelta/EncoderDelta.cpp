@@ -0,0 +1,16 @@
+/*
+Class to turn a free-running 32 bits counter into deltas
+*/
+
+#include "EncoderDelta.h"
+
+int32_t EncoderDelta::update(int32_t count){
+  uint32_t current = (uint32_t)count;
+  int32_t delta = (int32_t)(current - last_);
+  last_ = current;
+  return delta;
+};
+
+void EncoderDelta::rebase(int32_t from, int32_t to){
+  last_ += (uint32_t)to - (uint32_t)from;
+};
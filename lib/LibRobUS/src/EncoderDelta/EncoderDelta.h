@@ -0,0 +1,46 @@
+/*
+Class to turn a free-running 32 bits counter into deltas
+The counter is never reset, so no step is lost between a read and a reset,
+and the deltas stay right when the counter wraps around.
+*/
+
+#ifndef EncoderDelta_H_
+#define EncoderDelta_H_
+
+#include <Arduino.h>
+
+class EncoderDelta
+{
+  public:
+    /** Method to set the counter value from which the next delta is counted
+
+    @param count
+    current value of the counter
+    */
+    void start(int32_t count){ last_ = (uint32_t)count; };
+
+    /** Method to compute the number of steps since the previous call
+
+    @param count
+    current value of the counter
+
+    @return number of steps since the previous call, right across a
+    wraparound as long as fewer than 2^31 steps happened between two calls
+    */
+    int32_t update(int32_t count);
+
+    /** Method to follow a counter written by software, keeping the steps
+    that were not read yet
+
+    @param from
+    value of the counter just before the write
+
+    @param to
+    value written to the counter
+    */
+    void rebase(int32_t from, int32_t to);
+
+  private:
+    uint32_t last_ = 0; // Unsigned, so the difference wraps instead of overflowing
+};
+#endif //EncoderDelta
@@ -30,23 +30,39 @@ void LS7366Counter::init(uint8_t slave_pin, uint8_t flag_pin)
 }
 
 int32_t LS7366Counter::read() {
-  uint32_t count[4];
-  int32_t count_value = 0;
-  // If id is out of range
-  digitalWrite(SLAVE_PIN_,LOW);        // Start communication
-  SPI.transfer(0x60);                     // Read command
+  return readRegister(0x60);              // Read CNTR
+}
 
-  // Read 4 bytes
-  for(uint8_t i = 0; i < 4; i++) {
-    count[i] = SPI.transfer(0x00);
+void LS7366Counter::latch(LS7366Counter* counters, uint8_t n) {
+  // Each module gets its own LOAD command with only its slave pin low, so a
+  // single MISO driver at a time, back to back with interrupts masked so the
+  // copies are only a byte transfer and two pin writes apart
+  uint8_t oldSREG = SREG;
+  cli();
+  for(uint8_t i = 0; i < n; i++) {
+    digitalWrite(counters[i].SLAVE_PIN_, LOW);
+    SPI.transfer(0xE8);                   // Load OTR from CNTR
+    digitalWrite(counters[i].SLAVE_PIN_, HIGH);
   }
-  digitalWrite(SLAVE_PIN_, HIGH);     // End of communication
+  SREG = oldSREG;
+}
 
-  // Concatenate the four bytes
-  for(uint8_t i = 0; i < 4; i++) {
-    count_value = (count_value << 8) + count[i];
-  }
-  return -count_value;
+int32_t LS7366Counter::readLatched() {
+  return readRegister(0x68);              // Read OTR
+}
+
+int32_t LS7366Counter::readRegister(uint8_t instruction) {
+  // Instruction then 4 bytes, in a single buffer transfer
+  uint8_t buffer[5] = {instruction, 0, 0, 0, 0};
+
+  digitalWrite(SLAVE_PIN_, LOW);        // Start communication
+  SPI.transfer(buffer, sizeof(buffer));
+  digitalWrite(SLAVE_PIN_, HIGH);       // End of communication
+
+  // Concatenate the four bytes, most significant first
+  uint32_t count_value = ((uint32_t)buffer[1] << 24) | ((uint32_t)buffer[2] << 16)
+                       | ((uint32_t)buffer[3] << 8) | buffer[4];
+  return -(int32_t)count_value;
 }
 
 void LS7366Counter::reset() {
@@ -38,9 +38,29 @@ class LS7366Counter
     */
     int32_t readReset();
 
+    /** Method to copy the counter of several modules to their output
+     * register (OTR), one module after the other with interrupts masked,
+     * so the copies are a few microseconds apart
+
+    @param counters
+    modules to latch, sharing the SPI bus
+
+    @param n
+    number of modules
+    */
+    static void latch(LS7366Counter* counters, uint8_t n);
+
+    /** Method to read the number of steps copied by the last latch()
+
+    @return number of steps [–2147483648, 2147483647]
+    */
+    int32_t readLatched();
+
   private:
     uint8_t SLAVE_PIN_;// {34, 35}; // Slave select pins
     uint8_t FLAG_PIN_ ;// {A14, A15};
+
+    int32_t readRegister(uint8_t instruction);
 };
 #endif // LS7366Counter
 
@@ -7,10 +7,18 @@ Class to interface some of the ArduinoX "on board" functionnalities
 
 #include <LibRobus.h>
 
+// MegaServo seizes its timers 12 servos at a time, in the order 5, 1, 3, 4 on
+// the ATmega1280 and timer 1 alone elsewhere. Timers 3 and 4 drive the motors.
+#if defined(__AVR_ATmega1280__) && MAX_SERVOS > 24
+#error "MegaServo would seize timers 3 and 4, which drive the motors: keep MAX_SERVOS at 24 or less"
+#elif !defined(__AVR_ATmega1280__) && MAX_SERVOS > 12
+#error "MegaServo only has timer 1 on this board: keep MAX_SERVOS at 12 or less"
+#endif
+
 // Objects creation
   Robus __Robus__;
   ArduinoX __AX__;
-  SoftTimer __timer__[MAX_N_TIMER];
+  SoftTimerQueue __timers__;
   AudioPlayer __audio__;
   DisplayLCD __display__;
   VexQuadEncoder __vex__;
@@ -23,12 +31,12 @@ Class to interface some of the ArduinoX "on board" functionnalities
   decode_results IR_MSG;
 
 
-void BoardInit(){
+void BoardInit(uint16_t motorPwm){
   // Initialize debug communication on Serial0
   Serial.begin(BAUD_RATE_SERIAL0);
   
   // Init ArduinoX
-  __AX__.init();
+  __AX__.init(motorPwm);
 
   // Init Robus
   __Robus__.init();
@@ -54,6 +62,10 @@ void MOTOR_SetSpeed(uint8_t id, float speed){
   __AX__.setSpeedMotor(id, speed);
 };
 
+void MOTOR_SetDuty(uint8_t id, int16_t duty){
+  __AX__.setDutyMotor(id, duty);
+};
+
 int32_t ENCODER_Read(uint8_t id){
   return __AX__.readEncoder(id);
 };
@@ -66,6 +78,46 @@ int32_t ENCODER_ReadReset(uint8_t id){
   return __AX__.readResetEncoder(id);
 };
 
+int32_t ENCODER_ReadDelta(uint8_t id){
+  return __AX__.readDeltaEncoder(id);
+};
+
+void ENCODER_ReadSample(EncoderSample& sample){
+  __AX__.readEncoderSample(sample);
+};
+
+uint32_t CONTROL_EnableInterrupt(uint32_t period){
+  return __AX__.enableControlInterrupt(period);
+};
+
+void CONTROL_DisableInterrupt(){
+  __AX__.disableControlInterrupt();
+};
+
+bool CONTROL_IsInterruptEnabled(){
+  return __AX__.isControlInterruptEnabled();
+};
+
+void CONTROL_ShareSPI(uint8_t csPin){
+  __AX__.shareSPI(csPin);
+};
+
+void CONTROL_LockSPI(){
+  __AX__.lockSPI();
+};
+
+void CONTROL_UnlockSPI(){
+  __AX__.unlockSPI();
+};
+
+// Interrupts stay enabled during the SPI transfers, so the servo pulses,
+// millis() and the IR receiver keep their timing. The handler skips its
+// sample while a device named by CONTROL_ShareSPI is selected, and returns
+// at once when an overflow comes while it is still running.
+ISR(TIMER3_OVF_vect, ISR_NOBLOCK){
+  __AX__.handleControlInterrupt();
+};
+
 void AUDIO_Play(uint16_t track){
   __audio__.play(track);
 };
@@ -170,50 +222,67 @@ void SERVO_SetAngle(uint8_t id, uint8_t angle){
   __Robus__.setAngleServo(id, angle);
 }
 
+void SERVO_SetSpeed(uint8_t id, float speed, float acceleration){
+  __Robus__.setSpeedServo(id, speed, acceleration);
+}
+
+unsigned long SERVO_MoveTo(uint8_t id, float angle, unsigned long delay){
+  return __Robus__.moveServo(id, angle, delay);
+}
+
+bool SERVO_IsMoving(uint8_t id){
+  return __Robus__.isServoMoving(id);
+}
+
+void SERVO_Update(){
+  __Robus__.updateServos();
+}
+
 void SOFT_TIMER_SetCallback(uint8_t id, void (*func)()){
-  if(id<0 || id>MAX_N_TIMER){
+  if(id>=MAX_N_TIMER){
     Serial.println("Invalid timer id!");
     return;
   }
-  __timer__[id].setCallback(func);
+  __timers__.get(id).setCallback(func);
 };
 
 void SOFT_TIMER_SetDelay(uint8_t id, unsigned long delay){
-  if(id<0 || id>MAX_N_TIMER){
+  if(id>=MAX_N_TIMER){
     Serial.println("Invalid timer id!");
     return;
   }
-  __timer__[id].setDelay(delay);
+  __timers__.get(id).setDelay(delay);
 };
 
 void SOFT_TIMER_SetRepetition(uint8_t id, int32_t nrep){
-  if(id<0){
+  if(id>=MAX_N_TIMER){
     Serial.println("Invalid timer id!");
     return;
   }
-  __timer__[id].setRepetition(nrep);
+  __timers__.get(id).setRepetition(nrep);
+  __timers__.schedule(id);
 };
 
 void SOFT_TIMER_Enable(uint8_t id){
-  if(id<0 || id>MAX_N_TIMER){
+  if(id>=MAX_N_TIMER){
     Serial.println("Invalid timer id!");
     return;
   }
-  __timer__[id].enable();
+  __timers__.get(id).enable();
+  __timers__.schedule(id);
 };
 
 void SOFT_TIMER_Disable(uint8_t id){
-  if(id<0 || id>MAX_N_TIMER){
+  if(id>=MAX_N_TIMER){
     Serial.println("Invalid timer id!");
     return;
   }
-  __timer__[id].disable();
+  __timers__.get(id).disable();
+  __timers__.schedule(id);
 };
 
 void SOFT_TIMER_Update(){
-  for(uint8_t id = 0; id<MAX_N_TIMER; id++){
-    __timer__[id].update();
-  };
+  __timers__.update();
 };
 
 void BLUETOOTH_print(String msg){
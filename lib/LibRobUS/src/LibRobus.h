@@ -14,7 +14,7 @@ General librairies for Robus robot
 #include <AudioPlayer/AudioPlayer.h>
 #include <DisplayLCD/DisplayLCD.h>
 #include <VexQuadEncoder/VexQuadEncoder.h>
-#include <SoftTimer/SoftTimer.h>
+#include <SoftTimerQueue/SoftTimerQueue.h>
 
 // Third party libraries
 #include <IRremote/IRremote.h>
@@ -26,17 +26,25 @@ General librairies for Robus robot
 #define FRONT 2
 #define REAR 3
 
-#define MAX_N_TIMER 10 // Nombre maximum de Chronometres
 #define BAUD_RATE_SERIAL0 9600
 #define BAUD_RATE_BLUETOOTH 115200
 #define SerialBT Serial2
 #define SerialAudio Serial3
 #define IR_RECV_PIN 37
+#define CONTROL_INTERRUPT_PERIOD 2000 // Default period of the control interrupt (us)
 
 
 /** Function to initialize most variables to use in code
+
+@param motorPwm
+PWM of the motors: MOTOR_PWM_ARDUINO (8 bits, 490 Hz), MOTOR_PWM_10_BITS
+(7.8 kHz), MOTOR_PWM_20_KHZ (400 steps), or the TOP of a phase-correct PWM
+at F_CPU / (2 * TOP). Timers 3 and 4 are then given to the motors.
+MegaServo seizes one timer per 12 servos: only timer 1 on the ATmega2560,
+whose build skips its multi-timer table, and timer 5 then timer 1 on the
+ATmega1280, where MAX_SERVOS is capped so it never reaches timers 3 and 4.
 */
-void BoardInit();
+void BoardInit(uint16_t motorPwm = MOTOR_PWM_ARDUINO);
 
 
 /** Function to initialize audio variables
@@ -64,6 +72,17 @@ floating value between [-1.0, 1.0]
 */
 void MOTOR_SetSpeed(uint8_t id, float speed);
 
+/** Function to control the two DC motors on robots without any floating
+point operation
+
+@param id
+identification of the motor (LEFT(0) or RIGHT(1))
+
+@param duty, reprensents direction and amplitude of PWM
+integer value between [-MOTOR_DUTY_MAX, MOTOR_DUTY_MAX], 32767 being full speed
+*/
+void MOTOR_SetDuty(uint8_t id, int16_t duty);
+
 
 /** Function to read the number of pulses from the encoder counter
 
@@ -90,6 +109,72 @@ identification of the motor (LEFT(0) or RIGHT(1))
 */
 int32_t ENCODER_ReadReset(uint8_t id);
 
+/** Function to read the number of pulses since the previous call.
+The counter is never reset, so unlike ENCODER_ReadReset no pulse arriving
+between the read and the reset is lost. The first call counts from BoardInit.
+
+@param id
+identification of the motor (LEFT(0) or RIGHT(1))
+
+@return number of pulses since the previous call, right when the counter
+wraps around
+*/
+int32_t ENCODER_ReadDelta(uint8_t id);
+
+/** Function to read both encoders as they were at nearly the same instant
+
+@param sample
+receives the counts of both encoders (LEFT(0) and RIGHT(1)), the micros()
+when they were read and the number of samples taken so far
+*/
+void ENCODER_ReadSample(EncoderSample& sample);
+
+/** Function to read the encoders and drive the motors from a timer interrupt
+at a fixed rate, whatever the rest of the code is doing.
+ENCODER_ functions then return the counts of the last interrupt and
+MOTOR_SetSpeed is applied by the next one. Both take a few microseconds.
+The interrupt is the overflow of timer 3, which also makes the PWM of the
+motors, so the period is a whole number of PWM periods, and at least
+CONTROL_MIN_PERIOD so a sample always ends before the next one starts.
+
+@param period
+wanted time between two interrupts in microseconds
+
+@return actual time between two interrupts in microseconds
+*/
+uint32_t CONTROL_EnableInterrupt(uint32_t period = CONTROL_INTERRUPT_PERIOD);
+
+/** Function to go back to reading the encoders and driving the motors
+on each call
+*/
+void CONTROL_DisableInterrupt();
+
+/** Function to know if the encoders and motors are handled by the interrupt
+
+@return true, if the control interrupt is enabled. Else false.
+*/
+bool CONTROL_IsInterruptEnabled();
+
+/** Function to name the chip select of another device on the SPI bus, such
+as the SD card. The control interrupt takes no sample while that device is
+selected, and takes it on a later PWM period instead.
+@note Interrupts stay enabled during the SPI transfers of the other devices
+
+@param csPin
+chip select pin of the device [CONTROL_SHARED_SPI pins at most]
+*/
+void CONTROL_ShareSPI(uint8_t csPin);
+
+/** Function to keep the control interrupt off the SPI bus during transfers
+made with every chip select HIGH, such as the clocks that wake up an SD card.
+Calls nest, each one ends with CONTROL_UnlockSPI.
+*/
+void CONTROL_LockSPI();
+
+/** Function to give the SPI bus back to the control interrupt
+*/
+void CONTROL_UnlockSPI();
+
 /** Function to play an audio track on mp3 player
 This function is non-blocking
 
@@ -251,6 +336,50 @@ An angle value in the range defined in global variable
 */
 void SERVO_SetAngle(uint8_t id, uint8_t angle);
 
+/** Function to set the speed limits of the moves of SERVO_MoveTo
+
+@param id
+index of the desired servomotor [0, 1]
+
+@param speed
+highest speed in degrees per second, 0 to jump to the angle
+
+@param acceleration
+acceleration and deceleration in degrees per second squared, 0 for none
+*/
+void SERVO_SetSpeed(uint8_t id, float speed, float acceleration = 0);
+
+/** Function to move a Servomotor to an angle, ramping at the speed set by
+SERVO_SetSpeed. The angle leaves and reaches its target at zero speed.
+@note SERVO_Update must be called in the loop while the servo moves
+
+@param id
+index of the desired servomotor [0, 1]
+
+@param angle
+An angle value in the range defined in global variable
+
+@param delay
+time to wait in ms before the move starts
+
+@return time in ms until the servo is at the angle
+*/
+unsigned long SERVO_MoveTo(uint8_t id, float angle, unsigned long delay = 0);
+
+/** Function to know if a Servomotor is still moving
+
+@param id
+index of the desired servomotor [0, 1]
+
+@return true until the servo is at the angle of SERVO_MoveTo, else false
+*/
+bool SERVO_IsMoving(uint8_t id);
+
+/** Function to send the angles of the moves to the Servomotors
+@note Call it in the loop, at least every 20 ms while a servo moves
+*/
+void SERVO_Update();
+
 /** Function to set a callback to a timer
 
 @param id
@@ -300,6 +429,9 @@ void SOFT_TIMER_Disable(uint8_t id);
 /** Function to call a callback if callTime_ is passed for a timer
 
 @note the next callTime_ and nRep_ is computed if necessary
+@note only the timers that are due are looked at, millis() is read once
+and periodic timers are scheduled from their previous callTime_, so they
+do not drift. MAX_N_TIMER can be raised with a build flag.
 */
 void SOFT_TIMER_Update();
 
@@ -61,7 +61,7 @@
 #define TICKS_PER_uS     (clockCyclesPerMicrosecond() / 8)  // number of timer ticks per microsecond with prescale of 8
 
 #define SERVOS_PER_TIMER   12                               // the maximum number of servos controlled by one timer 
-#define TRIM_DURATION     (SERVOS_PER_TIMER/2)             // compensation ticks to trim adjust for digitalWrite delays 
+#define TRIM_DURATION     3                                // compensation in uS: ~4 uS of ISR entry before the pulse ends, less ~1 uS from setting OCR to the pulse start
 
 #define NBR_TIMERS        (MAX_SERVOS / SERVOS_PER_TIMER)
 
@@ -89,18 +89,19 @@ uint8_t ServoCount = 0;	                                   // the total number o
 
 static inline void handle_interrupts(servoTimer_t timer, volatile uint16_t *TCNTn, volatile uint16_t* OCRnA)
 {
+  // Interrupts are off in the ISR, so the pins are written straight to their port
   if( Channel[timer] < 0 )
     *TCNTn = 0; // channel set to -1 indicated that refresh interval completed so reset the timer 
   else{
     if( SERVO_INDEX(timer,Channel[timer]) < ServoCount && SERVO(timer,Channel[timer]).Pin.isActive == true )  
-      digitalWrite( SERVO(timer,Channel[timer]).Pin.nbr,LOW); // pulse this channel low if activated   
+      *SERVO(timer,Channel[timer]).port &= ~SERVO(timer,Channel[timer]).mask; // pulse this channel low if activated   
   }
 
   Channel[timer]++;    // increment to the next channel
   if( SERVO_INDEX(timer,Channel[timer]) < ServoCount && Channel[timer] < SERVOS_PER_TIMER) {
     *OCRnA = *TCNTn + SERVO(timer,Channel[timer]).ticks;
     if(SERVO(timer,Channel[timer]).Pin.isActive == true)	   // check if activated
-      digitalWrite( SERVO(timer,Channel[timer]).Pin.nbr,HIGH); // its an active channel so pulse it high   
+      *SERVO(timer,Channel[timer]).port |= SERVO(timer,Channel[timer]).mask; // its an active channel so pulse it high   
   }	
   else { 
     // finished all channels so wait for the refresh period to expire before starting over 
@@ -218,6 +219,8 @@ uint8_t MegaServo::attach(int pin, int min, int max)
   if(this->servoIndex < MAX_SERVOS ) {
     pinMode( pin, OUTPUT) ;                                   // set servo pin to output
     servos[this->servoIndex].Pin.nbr = pin;  
+    servos[this->servoIndex].port = portOutputRegister(digitalPinToPort(pin));
+    servos[this->servoIndex].mask = digitalPinToBitMask(pin);
 	// todo min/max check: abs(min - MIN_PULSE_WIDTH) /4 < 128 
 	servos[this->servoIndex].min  = (MIN_PULSE_WIDTH - min)/4; //resolution of min/max is 4 uS
     servos[this->servoIndex].max  = (MAX_PULSE_WIDTH - max)/4; 
@@ -61,7 +61,7 @@
 #define REFRESH_INTERVAL    20000        // minumim time to refresh servos in microseconds 
 
 #if defined(__AVR_ATmega1280__)
-#define MAX_SERVOS             48        // the maximum number of servos  (valid range is from 1 to 48)
+#define MAX_SERVOS             24        // timers 5 and 1 only, timers 3 and 4 drive the Robus motors (valid range is from 1 to 48)
 #else
 #define MAX_SERVOS             12        // this library supports up to 12 on a standard Arduino
 #endif
@@ -75,6 +75,8 @@ typedef struct  {
 
 typedef struct {
     ServoPin_t Pin;
+    volatile uint8_t *port;  // output register of the pin, written directly by the ISR
+    uint8_t mask;            // bit of the pin in port
     unsigned int ticks;
     int8_t min;              // minimum is this value times 4 added to MIN_PULSE_WIDTH    
 	int8_t max;              // maximum is this value times 4 added to MAX_PULSE_WIDTH   
@@ -6,8 +6,43 @@ Class to control the PWM sent to the motors drives
 */
 #include "MotorControl.h"
 
+/** Registers of the 16 bits timer channel driving a PWM pin
+*/
+struct TimerChannel
+{
+  volatile uint8_t* tccrA;
+  volatile uint8_t* tccrB;
+  volatile uint16_t* icr;
+  volatile uint16_t* ocr;
+  uint8_t com; // COMnx1 bit connecting the channel to its pin
+};
+
+static bool findTimerChannel(uint8_t pin, TimerChannel& channel){
+  switch(digitalPinToTimer(pin)){
+#if defined(TCCR1A) && defined(COM1A1)
+    case TIMER1A: channel = {&TCCR1A, &TCCR1B, &ICR1, &OCR1A, COM1A1}; return true;
+    case TIMER1B: channel = {&TCCR1A, &TCCR1B, &ICR1, &OCR1B, COM1B1}; return true;
+#endif
+#if defined(TCCR3A) && defined(COM3A1)
+    case TIMER3A: channel = {&TCCR3A, &TCCR3B, &ICR3, &OCR3A, COM3A1}; return true;
+    case TIMER3B: channel = {&TCCR3A, &TCCR3B, &ICR3, &OCR3B, COM3B1}; return true;
+    case TIMER3C: channel = {&TCCR3A, &TCCR3B, &ICR3, &OCR3C, COM3C1}; return true;
+#endif
+#if defined(TCCR4A) && defined(COM4A1)
+    case TIMER4A: channel = {&TCCR4A, &TCCR4B, &ICR4, &OCR4A, COM4A1}; return true;
+    case TIMER4B: channel = {&TCCR4A, &TCCR4B, &ICR4, &OCR4B, COM4B1}; return true;
+    case TIMER4C: channel = {&TCCR4A, &TCCR4B, &ICR4, &OCR4C, COM4C1}; return true;
+#endif
+#if defined(TCCR5A) && defined(COM5A1)
+    case TIMER5A: channel = {&TCCR5A, &TCCR5B, &ICR5, &OCR5A, COM5A1}; return true;
+    case TIMER5B: channel = {&TCCR5A, &TCCR5B, &ICR5, &OCR5B, COM5B1}; return true;
+    case TIMER5C: channel = {&TCCR5A, &TCCR5B, &ICR5, &OCR5C, COM5C1}; return true;
+#endif
+    default: return false;
+  }
+}
 
-void MotorControl::init(uint8_t pwm_pin, uint8_t dir_pin) {
+void MotorControl::init(uint8_t pwm_pin, uint8_t dir_pin, uint16_t pwm_top) {
   // For each defined motor
   PWM_PIN_ = pwm_pin;
   DIR_PIN_ = dir_pin;
@@ -15,16 +50,84 @@ void MotorControl::init(uint8_t pwm_pin, uint8_t dir_pin) {
   pinMode(PWM_PIN_, OUTPUT);
   pinMode(DIR_PIN_, OUTPUT);
 
+  dirPort_ = portOutputRegister(digitalPinToPort(DIR_PIN_));
+  dirMask_ = digitalPinToBitMask(DIR_PIN_);
+  direction_ = 0;
+
+  // The Arduino core sets the timers in phase-correct 8 bits PWM
+  top_ = 255;
+  prescaler_ = 64;
+  ocr_ = NULL;
+
+  TimerChannel channel;
+  if(!findTimerChannel(PWM_PIN_, channel)){
+    return;
+  }
+
+  uint8_t oldSREG = SREG;
+  cli();
+  if(pwm_top >= 3){
+    // Phase-correct PWM with TOP in ICRn (WGMn3:0 = 10), CPU clock.
+    // The bits sit at the same place in the registers of every 16 bits timer.
+    *channel.tccrA = (*channel.tccrA & ~(_BV(WGM11) | _BV(WGM10))) | _BV(WGM11);
+    *channel.tccrB = (*channel.tccrB & ~(_BV(WGM13) | _BV(WGM12) | _BV(CS12) | _BV(CS11) | _BV(CS10)))
+                   | _BV(WGM13) | _BV(CS10);
+    *channel.icr = pwm_top;
+    top_ = pwm_top;
+    prescaler_ = 1;
+  }
+  *channel.tccrA |= _BV(channel.com);
+  ocr_ = channel.ocr;
+  *ocr_ = 0;
+  SREG = oldSREG;
+}
+
+uint32_t MotorControl::getPeriodCycles() {
+  return 2UL * top_ * prescaler_;
 }
 
 void MotorControl::setSpeed(float speed) {
-  int pwm = abs(speed*255.0f); // Change speed to unsigned integer
+  setDuty(speedToDuty(speed));
+}
+
+void MotorControl::setDuty(int16_t duty) {
   // Switching polarity on DIR_PIN to change motor direction
-  if (speed > 0) {
-    digitalWrite(DIR_PIN_, LOW);
-  } else {
-    digitalWrite(DIR_PIN_, HIGH);
+  int8_t direction = (duty > 0) ? 1 : -1;
+  uint16_t magnitude = (duty < 0) ? -duty : duty;
+  if(magnitude > MOTOR_DUTY_MAX){
+    magnitude = MOTOR_DUTY_MAX;
+  }
+  // Rounded down like the float version, MOTOR_DUTY_MAX gives top_
+  uint16_t compare = ((uint32_t)magnitude * (top_ + 1UL)) >> 15;
+
+  // The port is shared with other pins written from interrupts
+  uint8_t oldSREG = SREG;
+  cli();
+  if(direction != direction_){
+    if(direction > 0){
+      *dirPort_ &= ~dirMask_;
+    }else{
+      *dirPort_ |= dirMask_;
+    }
+    direction_ = direction;
   }
   // SetPWM value
-  analogWrite(PWM_PIN_, (pwm > 255) ? 255 : static_cast<uint8_t>(pwm));
+  if(ocr_ != NULL){
+    *ocr_ = compare;
+  }
+  SREG = oldSREG;
+
+  if(ocr_ == NULL){
+    analogWrite(PWM_PIN_, compare);
+  }
+}
+
+int16_t MotorControl::speedToDuty(float speed) {
+  if(speed >= 1.0f){
+    return MOTOR_DUTY_MAX;
+  }
+  if(speed <= -1.0f){
+    return -MOTOR_DUTY_MAX;
+  }
+  return (int16_t)(speed * MOTOR_DUTY_MAX);
 }
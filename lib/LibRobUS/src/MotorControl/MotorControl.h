@@ -8,12 +8,27 @@ Class to control the PWM sent to the motors drives
 #define MotorControl_H_
 
 #include <Arduino.h>
+
+#define MOTOR_DUTY_MAX 32767 // Full speed for setDuty()
+
+// PWM of the motors, as the TOP of their timer counting at the CPU clock.
+// Higher is finer, lower is faster: the PWM runs at F_CPU / (2 * TOP).
+#define MOTOR_PWM_ARDUINO 0    // 8 bits at 490 Hz, as set by the Arduino core
+#define MOTOR_PWM_10_BITS 1023 // 7.8 kHz
+#define MOTOR_PWM_20_KHZ 400   // Inaudible, 400 steps
+
 class MotorControl
 {
   public:
     /** Method to initialize the pins for motors control
+
+    @param pwm_top
+    MOTOR_PWM_ARDUINO to keep the PWM of the Arduino core, else the TOP of a
+    phase-correct PWM without prescaler, set on the whole 16 bits timer of
+    pwm_pin [3, 65535]. analogWrite(pin, value) on the other pins of that
+    timer then gives a duty of value / TOP.
     */
-    void init(uint8_t pwm_pin, uint8_t dir_pin);
+    void init(uint8_t pwm_pin, uint8_t dir_pin, uint16_t pwm_top = MOTOR_PWM_ARDUINO);
 
     /** Method to set the speed and direction of a DC motor
 
@@ -22,9 +37,39 @@ class MotorControl
     */
     void setSpeed(float speed);
 
+    /** Method to set the speed and direction of a DC motor without any
+     * floating point operation
+
+    @param duty [-MOTOR_DUTY_MAX, MOTOR_DUTY_MAX]
+    duty cycle of the PWM in 1/32767, its sign gives the direction
+    */
+    void setDuty(int16_t duty);
+
+    /** Method to convert a speed to a duty for setDuty()
+
+    @param speed [-1.0, 1.0]
+
+    @return duty [-MOTOR_DUTY_MAX, MOTOR_DUTY_MAX]
+    */
+    static int16_t speedToDuty(float speed);
+
+    /** Method to know the period of the PWM
+
+    @return duration of a PWM period, in CPU cycles
+    */
+    uint32_t getPeriodCycles();
+
   private:
     // Pins for PWM and DIRECTION
     uint8_t PWM_PIN_ ;// {5, 6};    // PWM pins
     uint8_t DIR_PIN_ ;// {30, 31};  // direction pins
+
+    // Registers found at init(), so setDuty() writes them directly
+    volatile uint8_t* dirPort_;
+    uint8_t dirMask_;
+    volatile uint16_t* ocr_; // Output compare register of the PWM pin, NULL if it is not on a 16 bits timer
+    uint16_t top_; // Counter value at 100% duty
+    uint16_t prescaler_;
+    int8_t direction_; // Last direction written, 0 before the first one
 };
 #endif //MotorControl
@@ -58,7 +58,52 @@ void Robus::setAngleServo(uint8_t id, uint8_t angle){
     Serial.println("Servo angle is out of range!");
   return;
   }
+  __motion__[id].jump(angle);
   __servo__[id].write(angle);
+  __servoPulse__[id] = __servo__[id].readMicroseconds();
+}
+
+void Robus::setSpeedServo(uint8_t id, float speed, float acceleration){
+   if(id<0 || id>1){
+    Serial.println("Invalid servo id!");
+  return;
+  }
+  __motion__[id].setLimits(speed, acceleration);
+}
+
+unsigned long Robus::moveServo(uint8_t id, float angle, unsigned long delay){
+   if(id<0 || id>1){
+    Serial.println("Invalid servo id!");
+  return 0;
+  }
+  if(angle < __SERVO_RANGE__[0] || angle > __SERVO_RANGE__[1]){
+    Serial.println("Servo angle is out of range!");
+  return 0;
+  }
+  unsigned long time = __motion__[id].moveTo(angle, millis(), delay);
+  updateServos();
+  return time;
+}
+
+bool Robus::isServoMoving(uint8_t id){
+  if(id<0 || id>1){
+    Serial.println("Invalid servo id!");
+  return false;
+  }
+  return __motion__[id].isMoving(millis());
+}
+
+void Robus::updateServos(){
+  unsigned long now = millis();
+  for(uint8_t id = 0; id < 2; id++){
+    // Same mapping as MegaServo::write(), in us rather than whole degrees
+    float angle = __motion__[id].getAngle(now);
+    uint16_t pulse = MIN_PULSE_WIDTH + angle * (MAX_PULSE_WIDTH - MIN_PULSE_WIDTH) / 180.0 + 0.5;
+    if(pulse != __servoPulse__[id] && __servo__[id].attached()){
+      __servo__[id].writeMicroseconds(pulse);
+      __servoPulse__[id] = pulse;
+    }
+  }
 }
 
 float Robus::getRangeSonar(uint8_t id){
@@ -10,6 +10,7 @@ Class to interface Robus board functionnalities
 
 #include <Arduino.h>
 #include <MegaServo/MegaServo.h>
+#include <ServoMotion/ServoMotion.h>
 //#include <Servo.h>
 #include <LS7366Counter/LS7366Counter.h>
 #include <SRF04Sonar/SRF04Sonar.h>
@@ -74,6 +75,45 @@ class Robus
     */
     void setAngleServo(uint8_t id, uint8_t angle);
 
+    /** Method to set the speed limits of the moves of a Servomotor
+    @param id
+    the id of the disired servo [0, 1]
+
+    @param speed
+    highest speed in degrees per second, 0 to jump to the angle
+
+    @param acceleration
+    acceleration in degrees per second squared, 0 for none
+    @return void.
+    */
+    void setSpeedServo(uint8_t id, float speed, float acceleration);
+
+    /** Method to move a Servomotor to an angle within its speed limits
+    @param id
+    the id of the disired servo [0, 1]
+
+    @param angle
+    the angle desired. The range is defined by __SERVO_RANGE__
+
+    @param delay
+    time to wait in ms before the move starts
+    @return time in ms until the servo is at the angle.
+    */
+    unsigned long moveServo(uint8_t id, float angle, unsigned long delay);
+
+    /** Method to verify if a Servomotor is still moving
+    @param id
+    the id of the disired servo [0, 1]
+
+    @return true until the servo is at the angle of its last move.
+    */
+    bool isServoMoving(uint8_t id);
+
+    /** Method to send the angles of the moves to the Servomotors
+    @return void.
+    */
+    void updateServos();
+
     /** Method to get range in cm with a sonar
     @param id
     the id of the disired sonar [0, 1]
@@ -92,6 +132,8 @@ class Robus
     const uint8_t __SONAR_TRIG_PINS__[2] = {23, 25};
     //Servo __servo__[2];
     MegaServo __servo__[2];
+    ServoMotion __motion__[2];
+    uint16_t __servoPulse__[2] = {0, 0}; // last pulse width written, in us
     SRF04Sonar __sonar__[2];
 };
 #endif //Robus_H_
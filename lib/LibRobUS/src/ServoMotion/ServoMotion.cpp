@@ -0,0 +1,89 @@
+/*
+Class to ramp a servomotor angle with a trapezoidal speed profile
+*/
+
+#include "ServoMotion.h"
+
+void ServoMotion::setLimits(float speed, float acceleration){
+  speed_ = speed;
+  acceleration_ = acceleration;
+};
+
+void ServoMotion::jump(float angle){
+  from_ = angle;
+  to_ = angle;
+  duration_ = 0;
+  moving_ = false;
+};
+
+unsigned long ServoMotion::moveTo(float angle, unsigned long now, unsigned long delay){
+  if(angle == to_){
+    return getRemainingTime(now);
+  }
+
+  from_ = getAngle(now);
+  to_ = angle;
+  start_ = now + delay;
+  duration_ = profileTime(fabs(to_ - from_), speed_, acceleration_, peak_);
+  ramp_ = acceleration_ > 0 ? peak_ / acceleration_ : 0;
+  end_ = start_ + (unsigned long)ceil(duration_ * 1000) + SERVO_MOTION_SETTLE_TIME;
+  moving_ = true;
+  return end_ - now;
+};
+
+float ServoMotion::getAngle(unsigned long now){
+  long elapsed = (long)(now - start_);
+  if(!moving_ || elapsed >= duration_ * 1000){
+    return to_;
+  }
+  if(elapsed <= 0){
+    return from_;
+  }
+
+  float t = elapsed / 1000.0;
+  float distance;
+  if(t < ramp_){
+    distance = 0.5 * peak_ / ramp_ * t * t;
+  }else if(t > duration_ - ramp_){
+    float left = duration_ - t;
+    distance = fabs(to_ - from_) - 0.5 * peak_ / ramp_ * left * left;
+  }else{
+    distance = peak_ * (t - 0.5 * ramp_);
+  }
+  return to_ > from_ ? from_ + distance : from_ - distance;
+};
+
+unsigned long ServoMotion::getRemainingTime(unsigned long now){
+  if(!moving_){
+    return 0;
+  }
+  long remaining = (long)(end_ - now);
+  if(remaining <= 0){
+    moving_ = false;
+    return 0;
+  }
+  return remaining;
+};
+
+unsigned long ServoMotion::travelTime(float distance, float speed, float acceleration){
+  float peak;
+  return (unsigned long)ceil(profileTime(distance, speed, acceleration, peak) * 1000) + SERVO_MOTION_SETTLE_TIME;
+};
+
+float ServoMotion::profileTime(float distance, float speed, float acceleration, float& peak){
+  if(speed <= 0){
+    peak = 0;
+    return 0;
+  }
+  if(acceleration <= 0){
+    peak = speed;
+    return distance / speed;
+  }
+  // Too short to reach the speed: accelerate half way, then decelerate
+  if(distance * acceleration < speed * speed){
+    peak = sqrt(distance * acceleration);
+    return 2 * peak / acceleration;
+  }
+  peak = speed;
+  return distance / speed + speed / acceleration;
+};
@@ -0,0 +1,117 @@
+/*
+Class to ramp a servomotor angle with a trapezoidal speed profile
+The angle leaves and reaches its target at zero speed, so the arm does not
+hit its stop, and the time the move ends is known when it starts.
+*/
+
+#ifndef ServoMotion_H_
+#define ServoMotion_H_
+
+#include <Arduino.h>
+
+// Time for the last commanded angle to reach the servo, one pulse period in ms
+#ifndef SERVO_MOTION_SETTLE_TIME
+#define SERVO_MOTION_SETTLE_TIME 20
+#endif
+
+class ServoMotion
+{
+  public:
+    /** Method to set the speed limits of the next moves
+
+    @param speed
+    highest speed in degrees per second, 0 for moves that jump to the target
+
+    @param acceleration
+    acceleration and deceleration in degrees per second squared, 0 to start
+    and stop at full speed
+    */
+    void setLimits(float speed, float acceleration);
+
+    /** Method to put the angle on a value at once, ending any move
+
+    @param angle
+    the angle in degrees
+    */
+    void jump(float angle);
+
+    /** Method to start a move toward an angle, from the angle at that time
+    and at zero speed. Asking again for the target of the current move
+    leaves it alone.
+
+    @param angle
+    the target angle in degrees
+
+    @param now
+    millis() at the time of the call
+
+    @param delay
+    time to wait in ms before the move starts
+
+    @return time in ms from now until the servo is at the target
+    */
+    unsigned long moveTo(float angle, unsigned long now, unsigned long delay = 0);
+
+    /** Method to compute the angle to command
+
+    @param now
+    millis() at the time of the call
+
+    @return the angle in degrees along the profile
+    */
+    float getAngle(unsigned long now);
+
+    /** Method to get the angle of the current or last move
+
+    @return the target angle in degrees
+    */
+    float getTarget(){ return to_; };
+
+    /** Method to check if a move is going on or waiting to start
+
+    @param now
+    millis() at the time of the call
+
+    @return true until the servo is at the target, else false
+    */
+    bool isMoving(unsigned long now){ return getRemainingTime(now) > 0; };
+
+    /** Method to compute how long the current move still lasts
+
+    @param now
+    millis() at the time of the call
+
+    @return time in ms until the servo is at the target, 0 once it is there
+    */
+    unsigned long getRemainingTime(unsigned long now);
+
+    /** Method to compute the time of a move of the given length
+
+    @param distance
+    length of the move in degrees
+
+    @param speed
+    highest speed in degrees per second, 0 for a jump
+
+    @param acceleration
+    acceleration in degrees per second squared, 0 for none
+
+    @return time in ms until the servo is at the target, SERVO_MOTION_SETTLE_TIME included
+    */
+    static unsigned long travelTime(float distance, float speed, float acceleration);
+
+  private:
+    static float profileTime(float distance, float speed, float acceleration, float& peak);
+
+    float speed_ = 0;
+    float acceleration_ = 0;
+    float from_ = 0;
+    float to_ = 0;
+    unsigned long start_ = 0;     // millis() when the move starts
+    unsigned long end_ = 0;       // millis() when the servo is at the target
+    bool moving_ = false;
+    float duration_ = 0;          // length of the profile in seconds
+    float ramp_ = 0;              // length of the acceleration, and of the deceleration, in seconds
+    float peak_ = 0;              // highest speed reached by the move, in degrees per second
+};
+#endif //ServoMotion
@@ -17,16 +17,30 @@ SoftTimer::SoftTimer(){
 };
 
 void SoftTimer::update(){
-  if(millis()>callTime_ && enable_ && nRep_){
-    f_();
-    if(nRep_ > 0){
-      currRep_--;
-      if(currRep_ == 0){
-        disable();
-      }
+  unsigned long now = millis();
+  if(isActive() && (long)(now - callTime_) >= 0){
+    fire(now);
+  }
+};
+
+void SoftTimer::fire(unsigned long now){
+  callTime_ += delay_;
+  if((long)(now - callTime_) >= 0){
+    // Late by a whole period or more, keep the phase and skip what was missed
+    if(delay_ == 0){
+      callTime_ = now + 1;
+    }else{
+      callTime_ += ((now - callTime_) / delay_ + 1) * delay_;
+    }
+  }
+  if(nRep_ > 0){
+    currRep_--;
+    if(currRep_ == 0){
+      disable();
     }
-    callTime_ = millis() + delay_;
   }
+  // Called last, so the callback can enable or disable its own timer
+  f_();
 };
 
 void SoftTimer::enable(){
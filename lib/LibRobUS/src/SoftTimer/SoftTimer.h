@@ -42,6 +42,28 @@ class SoftTimer
     @note the next callTime_ and nRep_ is computed if necessary
     */
     void update();
+
+    /** Method to call the callback now, computing the next callTime_ from
+     * the current one so a periodic timer does not drift.
+     * Periods that passed entirely are skipped, not called in a burst.
+
+    @param now
+    millis() read once by the caller
+    */
+    void fire(unsigned long now);
+
+    /** Method to know when the callback is due
+
+    @return the millis() at which the callback is due
+    */
+    unsigned long getCallTime() const { return callTime_; };
+
+    /** Method to know if the timer still has calls to make
+
+    @return true, if the timer is enabled and has repetitions left. Else false.
+    */
+    bool isActive() const { return enable_ && nRep_ != 0; };
+
     /** Function to a enable timer
     */
     void enable();
@@ -0,0 +1,100 @@
+/*
+Class to keep SoftTimer instances ordered by deadline
+The queue is a binary min-heap on callTime_. position_ finds a timer in the
+heap, so changing or removing one costs O(log n) like a call does.
+*/
+
+#include "SoftTimerQueue.h"
+
+SoftTimerQueue::SoftTimerQueue(){
+  size_ = 0;
+  for(uint8_t id = 0; id < MAX_N_TIMER; id++){
+    position_[id] = NOT_QUEUED;
+  }
+};
+
+void SoftTimerQueue::schedule(uint8_t id){
+  if(!timers_[id].isActive()){
+    remove(id);
+    return;
+  }
+  uint8_t index = position_[id];
+  if(index == NOT_QUEUED){
+    index = size_++;
+    heap_[index] = id;
+    position_[id] = index;
+  }
+  siftDown(siftUp(index));
+};
+
+void SoftTimerQueue::update(){
+  unsigned long now = millis();
+  while(size_ > 0){
+    uint8_t id = heap_[0];
+    if((long)(now - timers_[id].getCallTime()) < 0){
+      return; // The earliest timer is not due, none is
+    }
+    // Out of the heap while its callback runs, which may schedule other timers.
+    // The next callTime_ is after now, so each timer is called once at most.
+    remove(id);
+    timers_[id].fire(now);
+    schedule(id);
+  }
+};
+
+void SoftTimerQueue::remove(uint8_t id){
+  uint8_t index = position_[id];
+  if(index == NOT_QUEUED){
+    return;
+  }
+  position_[id] = NOT_QUEUED;
+  size_--;
+  if(index != size_){
+    // The last timer fills the hole
+    heap_[index] = heap_[size_];
+    position_[heap_[index]] = index;
+    siftDown(siftUp(index));
+  }
+};
+
+bool SoftTimerQueue::isEarlier(uint8_t a, uint8_t b){
+  // Compared through the difference, so the order survives the millis() rollover
+  return (long)(timers_[heap_[a]].getCallTime() - timers_[heap_[b]].getCallTime()) < 0;
+};
+
+void SoftTimerQueue::swap(uint8_t a, uint8_t b){
+  uint8_t id = heap_[a];
+  heap_[a] = heap_[b];
+  heap_[b] = id;
+  position_[heap_[a]] = a;
+  position_[heap_[b]] = b;
+};
+
+uint8_t SoftTimerQueue::siftUp(uint8_t index){
+  while(index > 0){
+    uint8_t parent = (index - 1) / 2;
+    if(!isEarlier(index, parent)){
+      break;
+    }
+    swap(index, parent);
+    index = parent;
+  }
+  return index;
+};
+
+void SoftTimerQueue::siftDown(uint8_t index){
+  while(true){
+    uint16_t child = 2 * (uint16_t)index + 1;
+    if(child >= size_){
+      return;
+    }
+    if(child + 1 < size_ && isEarlier(child + 1, child)){
+      child++;
+    }
+    if(!isEarlier(child, index)){
+      return;
+    }
+    swap(index, child);
+    index = child;
+  }
+};
@@ -0,0 +1,64 @@
+/*
+Class to keep SoftTimer instances ordered by deadline
+Only the timers that are due are looked at on each update, so the cost of
+an update does not grow with the number of timers.
+*/
+
+#ifndef SoftTimerQueue_H_
+#define SoftTimerQueue_H_
+
+#include <Arduino.h>
+#include <SoftTimer/SoftTimer.h>
+
+#ifndef MAX_N_TIMER
+#define MAX_N_TIMER 10 // Nombre maximum de Chronometres [1, 255]
+#endif
+
+class SoftTimerQueue
+{
+  public:
+    SoftTimerQueue();
+
+    /** Method to access a timer
+
+    @param id
+    index of the timer [0, MAX_N_TIMER-1]
+
+    @return the timer
+    */
+    SoftTimer& get(uint8_t id){ return timers_[id]; };
+
+    /** Method to put a timer back in order after it was changed.
+     * An active timer is queued at its callTime_, an inactive one is removed.
+
+    @param id
+    index of the timer [0, MAX_N_TIMER-1]
+    */
+    void schedule(uint8_t id);
+
+    /** Method to call the callbacks of every timer that is due.
+     * millis() is read once for all of them.
+    */
+    void update();
+
+    /** Method to know how many timers are queued
+
+    @return number of active timers
+    */
+    uint8_t size() const { return size_; };
+
+  private:
+    static const uint8_t NOT_QUEUED = 0xFF;
+
+    SoftTimer timers_[MAX_N_TIMER];
+    uint8_t heap_[MAX_N_TIMER]; // Timer ids, the earliest callTime_ first
+    uint8_t position_[MAX_N_TIMER]; // Index of each timer in heap_, or NOT_QUEUED
+    uint8_t size_;
+
+    void remove(uint8_t id);
+    bool isEarlier(uint8_t a, uint8_t b);
+    void swap(uint8_t a, uint8_t b);
+    uint8_t siftUp(uint8_t index);
+    void siftDown(uint8_t index);
+};
+#endif //SoftTimerQueue
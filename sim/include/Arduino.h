@@ -0,0 +1,104 @@
+/**
+ * @file Arduino.h
+ * @brief Host stand-in for the subset of the Arduino core used by RobusDraw.
+ *
+ * Time is simulated: millis() and micros() return a virtual clock that only
+ * moves when delay() is called or when the simulation advances it, so whole
+ * drawings can be replayed much faster than real time.
+ */
+
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define DEC 10
+#define HEX 16
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+class Print {
+    public:
+        virtual ~Print() {}
+
+        virtual size_t write(uint8_t c) = 0;
+        virtual size_t write(const uint8_t *buffer, size_t size);
+
+        size_t print(const char *text);
+        size_t print(char c);
+        size_t print(long value, int base = DEC);
+        size_t print(unsigned long value, int base = DEC);
+        size_t print(int value, int base = DEC) { return print((long) value, base); }
+        size_t print(unsigned int value, int base = DEC) { return print((unsigned long) value, base); }
+        size_t print(double value, int digits = 2);
+
+        size_t println();
+        template<typename T> size_t println(T value) { size_t n = print(value); return n + println(); }
+        template<typename T> size_t println(T value, int format) { size_t n = print(value, format); return n + println(); }
+};
+
+class HardwareSerial : public Print {
+    public:
+        void begin(unsigned long baud) { (void) baud; }
+        int available();
+        int read();
+        size_t write(uint8_t c) override;
+
+        /**
+         * @brief Silences the serial output, useful when benchmarking.
+         * @param enabled True to forward writes to stdout, false to drop them.
+         */
+        void setEcho(bool enabled) { echo = enabled; }
+
+    private:
+        bool echo = true;
+};
+
+extern HardwareSerial Serial;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+namespace Sim {
+    /**
+     * @brief Advances the simulated clock.
+     * @param us Number of microseconds to add to the clock.
+     */
+    void advanceMicros(unsigned long us);
+
+    /**
+     * @brief Sets the value returned by digitalRead() for a pin.
+     * @param pin The pin to drive.
+     * @param value The level to report.
+     */
+    void setPinLevel(uint8_t pin, uint8_t value);
+}
+
+#endif // SIM_ARDUINO_H
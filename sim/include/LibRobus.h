@@ -0,0 +1,99 @@
+/**
+ * @file LibRobus.h
+ * @brief Host stand-in for the LibRobus functions used by RobusDraw.
+ *
+ * Servo and motor commands are recorded so the simulation can inspect them.
+ */
+
+#ifndef SIM_LIBROBUS_H
+#define SIM_LIBROBUS_H
+
+#include <Arduino.h>
+
+#define LEFT 0
+#define RIGHT 1
+#define FRONT 2
+#define REAR 3
+
+#define SERVO_1 0
+#define SERVO_2 1
+
+#define MOTOR_PWM_ARDUINO 0
+#define MOTOR_PWM_10_BITS 1023
+#define MOTOR_PWM_20_KHZ 400
+
+#define CONTROL_INTERRUPT_PERIOD 2000
+
+struct EncoderSample {
+    int32_t count[2];
+    uint32_t time;
+    uint32_t sequence;
+};
+
+void BoardInit(uint16_t motorPwm = MOTOR_PWM_ARDUINO);
+
+void MOTOR_SetSpeed(uint8_t id, float speed);
+
+int32_t ENCODER_Read(uint8_t id);
+void ENCODER_Reset(uint8_t id);
+int32_t ENCODER_ReadReset(uint8_t id);
+int32_t ENCODER_ReadDelta(uint8_t id);
+void ENCODER_ReadSample(EncoderSample& sample);
+
+uint32_t CONTROL_EnableInterrupt(uint32_t period = CONTROL_INTERRUPT_PERIOD);
+void CONTROL_DisableInterrupt();
+bool CONTROL_IsInterruptEnabled();
+void CONTROL_ShareSPI(uint8_t csPin);
+void CONTROL_LockSPI();
+void CONTROL_UnlockSPI();
+
+void SERVO_Enable(uint8_t id);
+void SERVO_Disable(uint8_t id);
+void SERVO_SetAngle(uint8_t id, uint8_t angle);
+void SERVO_SetSpeed(uint8_t id, float speed, float acceleration = 0);
+unsigned long SERVO_MoveTo(uint8_t id, float angle, unsigned long delay = 0);
+bool SERVO_IsMoving(uint8_t id);
+void SERVO_Update();
+
+void AX_BuzzerON(uint32_t freq, uint64_t duration);
+
+bool ROBUS_IsBumper(uint8_t id);
+
+namespace Sim {
+    /**
+     * @brief Retrieves the angle a servo is commanded to, along its move.
+     * @param id The servo index.
+     * @return The angle rounded to the degree.
+     */
+    uint8_t getServoAngle(uint8_t id);
+
+    /**
+     * @brief Retrieves the number of times SERVO_MoveTo() sent a servo to a new angle.
+     * @param id The servo index.
+     * @return The number of moves.
+     */
+    unsigned long getServoMoves(uint8_t id);
+
+    /**
+     * @brief Retrieves the last speed sent to a motor.
+     * @param id The motor index.
+     * @return The speed in [-1.0, 1.0].
+     */
+    float getMotorSpeed(uint8_t id);
+
+    /**
+     * @brief Counts pulses on an encoder, wrapping around like the 32-bit hardware counter.
+     * @param id The encoder index.
+     * @param pulses The number of pulses, negative when the wheel turns backward.
+     */
+    void addEncoderPulses(uint8_t id, int32_t pulses);
+
+    /**
+     * @brief Sets the hardware counter of an encoder, as if it had counted up to there.
+     * @param id The encoder index.
+     * @param count The counter value.
+     */
+    void setEncoderCount(uint8_t id, int32_t count);
+}
+
+#endif // SIM_LIBROBUS_H
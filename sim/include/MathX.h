@@ -0,0 +1,21 @@
+/**
+ * @file MathX.h
+ * @brief Host stand-in for the MathX helpers used by RobusDraw.
+ */
+
+#ifndef SIM_MATHX_H
+#define SIM_MATHX_H
+
+#include <math.h>
+
+/**
+ * @brief Computes the euclidean distance between two points.
+ * @return The distance between (x1, y1) and (x2, y2).
+ */
+inline float dist(float x1, float y1, float x2, float y2) {
+    float dx = x2 - x1;
+    float dy = y2 - y1;
+    return sqrtf(dx * dx + dy * dy);
+}
+
+#endif // SIM_MATHX_H
@@ -0,0 +1,52 @@
+/**
+ * @file RobusPosition.h
+ * @brief Host stand-in for the RobusPosition and RobusMovement libraries.
+ *
+ * The robot is modelled as a unicycle that drives toward the current target
+ * at the follow velocity while turning proportionally to its heading error.
+ * Its forward speed changes at a bounded acceleration.
+ */
+
+#ifndef SIM_ROBUS_POSITION_H
+#define SIM_ROBUS_POSITION_H
+
+#include <LibRobus.h>
+#include <MathX.h>
+
+namespace RobusPosition {
+
+    struct Vector {
+        float x;
+        float y;
+    };
+
+    Vector getPosition();
+    float getOrientation();
+
+    void setTarget(float x, float y);
+    void startFollowingTarget();
+    void stopFollowingTarget();
+
+    void setFollowVelocity(float velocity);
+    void setFollowAngularVelocityScale(float scale);
+    void setCurveTightness(float tightness);
+
+    void update();
+}
+
+namespace RobusMovement {
+    void stop();
+    void setPIDAngular(float kp, float ki, float kd, float target);
+}
+
+namespace Sim {
+    /**
+     * @brief Places the simulated robot.
+     * @param x The x coordinate.
+     * @param y The y coordinate.
+     * @param orientation The heading in radians.
+     */
+    void setPose(float x, float y, float orientation);
+}
+
+#endif // SIM_ROBUS_POSITION_H
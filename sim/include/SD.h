@@ -0,0 +1,139 @@
+/**
+ * @file SD.h
+ * @brief In-memory stand-in for the Arduino SD library.
+ *
+ * Files live in RAM and are looked up case-insensitively, like on a FAT card.
+ * The host program mounts drawings with Sim::mountFile() before running.
+ *
+ * Every File call advances the simulated clock following a simple cost model
+ * of the Arduino SD library on a 16 MHz AVR: a fixed overhead per call, a
+ * per-byte copy out of the single 512 byte block cache and a sector load
+ * whenever the cache misses. flush() writes the cached sector back when
+ * the file was written to. Initializing the card, which SD.begin() and
+ * Sd2Card::init() both do, costs a few milliseconds.
+ */
+
+#ifndef SIM_SD_H
+#define SIM_SD_H
+
+#include <Arduino.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define O_READ 0x01
+#define O_WRITE 0x02
+#define O_APPEND 0x04
+#define O_CREAT 0x40
+
+#define SPI_HALF_SPEED 1
+
+#define FILE_READ O_READ
+#define FILE_WRITE (O_READ | O_WRITE | O_CREAT | O_APPEND)
+
+namespace Sim {
+    struct SDEntry {
+        std::string name;
+        std::vector<uint8_t> data;
+    };
+}
+
+class File : public Print {
+    public:
+        File() {}
+        File(std::shared_ptr<Sim::SDEntry> entry, uint8_t mode);
+
+        int read();
+        int read(void *buffer, uint16_t size);
+        int peek();
+        int available();
+        bool seek(uint32_t position);
+        uint32_t position();
+        uint32_t size();
+
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t *buffer, size_t size) override;
+        void flush();
+
+        void close();
+        char *name();
+
+        operator bool() const { return entry != nullptr; }
+
+    private:
+        void charge(uint32_t bytes);
+
+        std::shared_ptr<Sim::SDEntry> entry;
+        uint32_t cursor = 0;
+        bool dirty = false;
+        char fileName[13] = "";
+};
+
+/**
+ * @brief Card identification register, compared as a whole.
+ */
+struct cid_t {
+    uint8_t data[16];
+};
+
+class Sd2Card {
+    public:
+        bool init(uint8_t sckRateID, uint8_t chipSelectPin);
+        bool readCID(cid_t *cid);
+
+    private:
+        bool initialized = false;
+};
+
+class SDClass {
+    public:
+        bool begin(uint8_t chipSelect);
+        bool exists(const char *path);
+        File open(const char *path, uint8_t mode = FILE_READ);
+        bool remove(const char *path);
+};
+
+extern SDClass SD;
+
+namespace Sim {
+    /**
+     * @brief Adds or replaces a file on the simulated card.
+     * @param path The name of the file on the card.
+     * @param data The content of the file.
+     */
+    void mountFile(const char *path, const std::vector<uint8_t> &data);
+
+    /**
+     * @brief Inserts or removes the simulated card.
+     * @param present True if SD.begin() should succeed.
+     */
+    void setCardPresent(bool present);
+
+    /**
+     * @brief Sets the simulated cost of file accesses, charged to the simulated clock.
+     * @param callMicros Fixed cost of every File call, in microseconds.
+     * @param byteNanos Cost of every byte copied out of the block cache, in nanoseconds.
+     * @param sectorMicros Cost of loading a 512 byte sector that is not in the block cache, in microseconds.
+     */
+    void setSDCost(unsigned long callMicros, unsigned long byteNanos, unsigned long sectorMicros);
+
+    /**
+     * @brief Sets the simulated cost of initializing the card, on top of the sectors SD.begin() reads.
+     * @param initMicros The cost in microseconds.
+     */
+    void setSDInitCost(unsigned long initMicros);
+
+    /**
+     * @brief Retrieves the simulated time spent in File calls.
+     * @return The time in microseconds.
+     */
+    unsigned long long getSDMicros();
+
+    /**
+     * @brief Retrieves the number of File calls made.
+     * @return The number of calls.
+     */
+    unsigned long getSDCalls();
+}
+
+#endif // SIM_SD_H
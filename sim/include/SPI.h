@@ -0,0 +1,11 @@
+/**
+ * @file SPI.h
+ * @brief Host stand-in for the Arduino SPI library. The simulated card does not use the bus.
+ */
+
+#ifndef SIM_SPI_H
+#define SIM_SPI_H
+
+#include <Arduino.h>
+
+#endif // SIM_SPI_H
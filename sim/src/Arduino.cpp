@@ -0,0 +1,135 @@
+/**
+ * @file Arduino.cpp
+ * @brief Simulated clock, pins and serial port for the host build.
+ */
+
+#include <Arduino.h>
+#include <stdio.h>
+
+HardwareSerial Serial;
+
+namespace {
+    /**
+     * @brief Simulated time since boot in microseconds.
+     */
+    unsigned long long clockMicros = 0;
+
+    /**
+     * @brief Levels reported by digitalRead(), indexed by pin number.
+     */
+    uint8_t pinLevels[256] = {0};
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+        n += write(*buffer++);
+    }
+    return n;
+}
+
+size_t Print::print(const char *text) {
+    return write((const uint8_t *) text, strlen(text));
+}
+
+size_t Print::print(char c) {
+    return write((uint8_t) c);
+}
+
+size_t Print::print(long value, int base) {
+    char buffer[24];
+    if (base == HEX) {
+        snprintf(buffer, sizeof(buffer), "%lX", value);
+    } else {
+        snprintf(buffer, sizeof(buffer), "%ld", value);
+    }
+    return print(buffer);
+}
+
+size_t Print::print(unsigned long value, int base) {
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), base == HEX ? "%lX" : "%lu", value);
+    return print(buffer);
+}
+
+size_t Print::print(double value, int digits) {
+    char buffer[48];
+    snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+    return print(buffer);
+}
+
+size_t Print::println() {
+    return print("\r\n");
+}
+
+int HardwareSerial::available() {
+    return 0;
+}
+
+int HardwareSerial::read() {
+    return -1;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    if (echo && c != '\r') {
+        fputc(c, stdout);
+    }
+    return 1;
+}
+
+unsigned long millis() {
+    return (unsigned long) (clockMicros / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long) clockMicros;
+}
+
+void delay(unsigned long ms) {
+    clockMicros += (unsigned long long) ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us) {
+    clockMicros += us;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (mode == INPUT_PULLUP) {
+        pinLevels[pin] = HIGH;
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    pinLevels[pin] = value;
+}
+
+int digitalRead(uint8_t pin) {
+    return pinLevels[pin];
+}
+
+int analogRead(uint8_t pin) {
+    (void) pin;
+    return 0;
+}
+
+long random(long max) {
+    return max > 0 ? rand() % max : 0;
+}
+
+long random(long min, long max) {
+    return min >= max ? min : min + random(max - min);
+}
+
+void randomSeed(unsigned long seed) {
+    srand((unsigned int) seed);
+}
+
+namespace Sim {
+    void advanceMicros(unsigned long us) {
+        clockMicros += us;
+    }
+
+    void setPinLevel(uint8_t pin, uint8_t value) {
+        pinLevels[pin] = value;
+    }
+}
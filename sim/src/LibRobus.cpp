@@ -0,0 +1,171 @@
+/**
+ * @file LibRobus.cpp
+ * @brief Recording implementation of the LibRobus stand-ins.
+ */
+
+#include <LibRobus.h>
+#include <EncoderDelta/EncoderDelta.h>
+#include <ServoMotion/ServoMotion.h>
+
+namespace {
+    uint8_t servoAngles[2] = {0};
+    unsigned long servoMoves[2] = {0};
+    ServoMotion servoMotions[2];
+    bool servoEnabled[2] = {false};
+    float motorSpeeds[2] = {0};
+    int32_t encoders[2] = {0};
+    EncoderDelta encoderDeltas[2];
+    bool controlInterrupt = false;
+}
+
+void BoardInit(uint16_t motorPwm) {
+    (void) motorPwm;
+    encoderDeltas[0].start(encoders[0]);
+    encoderDeltas[1].start(encoders[1]);
+}
+
+void MOTOR_SetSpeed(uint8_t id, float speed) {
+    if (id < 2) {
+        motorSpeeds[id] = speed;
+    }
+}
+
+int32_t ENCODER_Read(uint8_t id) {
+    return id < 2 ? encoders[id] : 0;
+}
+
+void ENCODER_Reset(uint8_t id) {
+    if (id < 2) {
+        encoderDeltas[id].rebase(encoders[id], 0);
+        encoders[id] = 0;
+    }
+}
+
+int32_t ENCODER_ReadReset(uint8_t id) {
+    int32_t value = ENCODER_Read(id);
+    ENCODER_Reset(id);
+    return value;
+}
+
+// Same delta tracking as the robot, over the simulated counters
+int32_t ENCODER_ReadDelta(uint8_t id) {
+    return id < 2 ? encoderDeltas[id].update(encoders[id]) : 0;
+}
+
+void ENCODER_ReadSample(EncoderSample& sample) {
+    sample.count[0] = encoders[0];
+    sample.count[1] = encoders[1];
+    sample.time = micros();
+    sample.sequence = 0;
+}
+
+// There are no interrupts on the host, the flag is only recorded
+uint32_t CONTROL_EnableInterrupt(uint32_t period) {
+    controlInterrupt = true;
+    return period;
+}
+
+void CONTROL_DisableInterrupt() {
+    controlInterrupt = false;
+}
+
+bool CONTROL_IsInterruptEnabled() {
+    return controlInterrupt;
+}
+
+void CONTROL_ShareSPI(uint8_t csPin) {
+    (void) csPin;
+}
+
+void CONTROL_LockSPI() {
+}
+
+void CONTROL_UnlockSPI() {
+}
+
+void SERVO_Enable(uint8_t id) {
+    if (id < 2) {
+        servoEnabled[id] = true;
+    }
+}
+
+void SERVO_Disable(uint8_t id) {
+    if (id < 2) {
+        servoEnabled[id] = false;
+    }
+}
+
+void SERVO_SetAngle(uint8_t id, uint8_t angle) {
+    if (id < 2 && servoEnabled[id]) {
+        servoMotions[id].jump(angle);
+        servoAngles[id] = angle;
+    }
+}
+
+void SERVO_SetSpeed(uint8_t id, float speed, float acceleration) {
+    if (id < 2) {
+        servoMotions[id].setLimits(speed, acceleration);
+    }
+}
+
+// Same profile as the robot, sampled by SERVO_Update() on the simulated clock
+unsigned long SERVO_MoveTo(uint8_t id, float angle, unsigned long delay) {
+    if (id >= 2 || !servoEnabled[id]) {
+        return 0;
+    }
+
+    if (servoMotions[id].getTarget() != angle) {
+        servoMoves[id]++;
+    }
+    unsigned long time = servoMotions[id].moveTo(angle, millis(), delay);
+    SERVO_Update();
+    return time;
+}
+
+bool SERVO_IsMoving(uint8_t id) {
+    return id < 2 && servoMotions[id].isMoving(millis());
+}
+
+void SERVO_Update() {
+    for (uint8_t id = 0; id < 2; id++) {
+        if (servoEnabled[id]) {
+            servoAngles[id] = lround(servoMotions[id].getAngle(millis()));
+        }
+    }
+}
+
+void AX_BuzzerON(uint32_t freq, uint64_t duration) {
+    (void) freq;
+    (void) duration;
+}
+
+bool ROBUS_IsBumper(uint8_t id) {
+    (void) id;
+    return false;
+}
+
+namespace Sim {
+    uint8_t getServoAngle(uint8_t id) {
+        return id < 2 ? servoAngles[id] : 0;
+    }
+
+    unsigned long getServoMoves(uint8_t id) {
+        return id < 2 ? servoMoves[id] : 0;
+    }
+
+    float getMotorSpeed(uint8_t id) {
+        return id < 2 ? motorSpeeds[id] : 0;
+    }
+
+    void addEncoderPulses(uint8_t id, int32_t pulses) {
+        if (id < 2) {
+            encoders[id] = (int32_t) ((uint32_t) encoders[id] + (uint32_t) pulses);
+        }
+    }
+
+    void setEncoderCount(uint8_t id, int32_t count) {
+        if (id < 2) {
+            encoders[id] = count;
+        }
+    }
+}
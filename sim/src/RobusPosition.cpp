@@ -0,0 +1,146 @@
+/**
+ * @file RobusPosition.cpp
+ * @brief Kinematic robot model backing the RobusPosition stand-in.
+ */
+
+#include <RobusPosition.h>
+
+namespace {
+    /**
+     * @brief Largest turn rate of the simulated robot in radians per second.
+     */
+    const float MAX_ANGULAR_VELOCITY = 6.0;
+
+    /**
+     * @brief Largest change of the forward speed of the simulated robot, in units per second squared.
+     */
+    const float MAX_LINEAR_ACCELERATION = 25.0;
+
+    float x = 0;
+    float y = 0;
+    float orientation = 0;
+    float velocity = 0;
+
+    float targetX = 0;
+    float targetY = 0;
+    bool following = false;
+
+    float followVelocity = 6.0;
+    float followAngularVelocityScale = 3.0;
+
+    unsigned long lastUpdate = 0;
+
+    float wrapAngle(float angle) {
+        while (angle > PI) {
+            angle -= 2 * PI;
+        }
+        while (angle < -PI) {
+            angle += 2 * PI;
+        }
+        return angle;
+    }
+}
+
+namespace RobusPosition {
+    Vector getPosition() {
+        return {x, y};
+    }
+
+    float getOrientation() {
+        return orientation;
+    }
+
+    void setTarget(float _x, float _y) {
+        targetX = _x;
+        targetY = _y;
+    }
+
+    void startFollowingTarget() {
+        following = true;
+    }
+
+    void stopFollowingTarget() {
+        following = false;
+    }
+
+    void setFollowVelocity(float velocity) {
+        followVelocity = velocity;
+    }
+
+    void setFollowAngularVelocityScale(float scale) {
+        followAngularVelocityScale = scale;
+    }
+
+    void setCurveTightness(float tightness) {
+        (void) tightness;
+    }
+
+    /**
+     * @brief Integrates the robot pose over the simulated time elapsed since the previous call.
+     */
+    void update() {
+        unsigned long now = micros();
+        float dt = (now - lastUpdate) / 1000000.0;
+        lastUpdate = now;
+
+        if (!following) {
+            velocity = 0;
+            MOTOR_SetSpeed(LEFT, 0);
+            MOTOR_SetSpeed(RIGHT, 0);
+            return;
+        }
+
+        float error = wrapAngle(atan2f(targetY - y, targetX - x) - orientation);
+        float angularVelocity = followAngularVelocityScale * error;
+        if (angularVelocity > MAX_ANGULAR_VELOCITY) {
+            angularVelocity = MAX_ANGULAR_VELOCITY;
+        } else if (angularVelocity < -MAX_ANGULAR_VELOCITY) {
+            angularVelocity = -MAX_ANGULAR_VELOCITY;
+        }
+
+        float targetVelocity = followVelocity * cosf(error);
+        if (targetVelocity < 0) {
+            targetVelocity = 0;
+        }
+
+        float maxChange = MAX_LINEAR_ACCELERATION * dt;
+        if (targetVelocity > velocity + maxChange) {
+            velocity += maxChange;
+        } else if (targetVelocity < velocity - maxChange) {
+            velocity -= maxChange;
+        } else {
+            velocity = targetVelocity;
+        }
+
+        orientation = wrapAngle(orientation + angularVelocity * dt);
+        x += velocity * cosf(orientation) * dt;
+        y += velocity * sinf(orientation) * dt;
+
+        MOTOR_SetSpeed(LEFT, velocity / followVelocity);
+        MOTOR_SetSpeed(RIGHT, velocity / followVelocity);
+    }
+}
+
+namespace RobusMovement {
+    void stop() {
+        velocity = 0;
+        MOTOR_SetSpeed(LEFT, 0);
+        MOTOR_SetSpeed(RIGHT, 0);
+    }
+
+    void setPIDAngular(float kp, float ki, float kd, float target) {
+        (void) kp;
+        (void) ki;
+        (void) kd;
+        (void) target;
+    }
+}
+
+namespace Sim {
+    void setPose(float _x, float _y, float _orientation) {
+        x = _x;
+        y = _y;
+        orientation = _orientation;
+        lastUpdate = micros();
+    }
+}
@@ -0,0 +1,262 @@
+/**
+ * @file SD.cpp
+ * @brief In-memory card used by the host build.
+ */
+
+#include <SD.h>
+#include <ctype.h>
+#include <map>
+
+SDClass SD;
+
+namespace {
+    /**
+     * @brief Files on the simulated card, keyed by their upper-case name.
+     */
+    std::map<std::string, std::shared_ptr<Sim::SDEntry>> files;
+
+    /**
+     * @brief Whether SD.begin() reports a card.
+     */
+    bool cardPresent = true;
+
+    const uint32_t SECTOR_SIZE = 512;
+
+    unsigned long callCost = 10;
+    unsigned long byteCost = 500;
+    unsigned long sectorCost = 1200;
+    unsigned long initCost = 6000;
+
+    /**
+     * @brief Number of times a card was inserted, reported in the CID so a swapped card can be told apart.
+     */
+    uint8_t cardSerial = 1;
+
+    unsigned long long spentMicros = 0;
+    unsigned long calls = 0;
+
+    /**
+     * @brief The sector held by the simulated block cache.
+     */
+    const Sim::SDEntry *cachedEntry = nullptr;
+    uint32_t cachedSector = 0;
+
+    void chargeCommand(unsigned long cost) {
+        calls++;
+        spentMicros += cost;
+        Sim::advanceMicros(cost);
+    }
+
+    std::string normalize(const char *path) {
+        std::string name;
+        for (const char *c = path; *c; c++) {
+            if (*c != '/') {
+                name += (char) toupper(*c);
+            }
+        }
+        return name;
+    }
+}
+
+File::File(std::shared_ptr<Sim::SDEntry> entry, uint8_t mode) : entry(entry) {
+    strncpy(fileName, entry->name.c_str(), sizeof(fileName) - 1);
+    cursor = (mode & O_APPEND) ? entry->data.size() : 0;
+}
+
+void File::charge(uint32_t bytes) {
+    unsigned long long cost = callCost + (unsigned long long) bytes * byteCost / 1000;
+
+    if (entry) {
+        uint32_t first = cursor / SECTOR_SIZE;
+        uint32_t last = bytes > 0 ? (cursor + bytes - 1) / SECTOR_SIZE : first;
+        for (uint32_t sector = first; sector <= last; sector++) {
+            if (cachedEntry != entry.get() || cachedSector != sector) {
+                cost += sectorCost;
+                cachedEntry = entry.get();
+                cachedSector = sector;
+            }
+        }
+    }
+
+    calls++;
+    spentMicros += cost;
+    Sim::advanceMicros(cost);
+}
+
+int File::read() {
+    if (!entry || cursor >= entry->data.size()) {
+        charge(0);
+        return -1;
+    }
+    charge(1);
+    return entry->data[cursor++];
+}
+
+int File::read(void *buffer, uint16_t size) {
+    if (!entry) {
+        return -1;
+    }
+    uint32_t count = entry->data.size() - cursor;
+    if (count > size) {
+        count = size;
+    }
+    charge(count);
+    memcpy(buffer, entry->data.data() + cursor, count);
+    cursor += count;
+    return count;
+}
+
+int File::peek() {
+    charge(0);
+    if (!entry || cursor >= entry->data.size()) {
+        return -1;
+    }
+    return entry->data[cursor];
+}
+
+int File::available() {
+    charge(0);
+    return entry ? entry->data.size() - cursor : 0;
+}
+
+bool File::seek(uint32_t position) {
+    charge(0);
+    if (!entry || position > entry->data.size()) {
+        return false;
+    }
+    cursor = position;
+    return true;
+}
+
+uint32_t File::position() {
+    return cursor;
+}
+
+uint32_t File::size() {
+    return entry ? entry->data.size() : 0;
+}
+
+size_t File::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t File::write(const uint8_t *buffer, size_t size) {
+    if (!entry) {
+        return 0;
+    }
+    charge(size);
+    if (cursor + size > entry->data.size()) {
+        entry->data.resize(cursor + size);
+    }
+    memcpy(entry->data.data() + cursor, buffer, size);
+    cursor += size;
+    dirty = true;
+    return size;
+}
+
+void File::flush() {
+    if (dirty) {
+        calls++;
+        spentMicros += sectorCost;
+        Sim::advanceMicros(sectorCost);
+        dirty = false;
+    }
+}
+
+void File::close() {
+    flush();
+    entry = nullptr;
+    cursor = 0;
+}
+
+char *File::name() {
+    return fileName;
+}
+
+bool Sd2Card::init(uint8_t sckRateID, uint8_t chipSelectPin) {
+    (void) sckRateID;
+    (void) chipSelectPin;
+    chargeCommand(initCost);
+    initialized = cardPresent;
+    return initialized;
+}
+
+bool Sd2Card::readCID(cid_t *cid) {
+    chargeCommand(callCost + 16 * byteCost / 1000);
+    if (!initialized || !cardPresent) {
+        return false;
+    }
+    memset(cid->data, 0, sizeof(cid->data));
+    cid->data[10] = cardSerial;
+    return true;
+}
+
+bool SDClass::begin(uint8_t chipSelect) {
+    (void) chipSelect;
+    // Card initialization, then the boot sector and the root directory
+    chargeCommand(initCost);
+    if (cardPresent) {
+        chargeCommand(2 * sectorCost);
+    }
+    return cardPresent;
+}
+
+bool SDClass::exists(const char *path) {
+    return cardPresent && files.count(normalize(path)) > 0;
+}
+
+File SDClass::open(const char *path, uint8_t mode) {
+    if (!cardPresent) {
+        return File();
+    }
+
+    std::string name = normalize(path);
+    auto it = files.find(name);
+    if (it == files.end()) {
+        if (!(mode & O_CREAT)) {
+            return File();
+        }
+        auto entry = std::make_shared<Sim::SDEntry>();
+        entry->name = name;
+        it = files.emplace(name, entry).first;
+    }
+    return File(it->second, mode);
+}
+
+bool SDClass::remove(const char *path) {
+    return files.erase(normalize(path)) > 0;
+}
+
+namespace Sim {
+    void mountFile(const char *path, const std::vector<uint8_t> &data) {
+        auto entry = std::make_shared<SDEntry>();
+        entry->name = normalize(path);
+        entry->data = data;
+        files[entry->name] = entry;
+    }
+
+    void setCardPresent(bool present) {
+        if (present && !cardPresent) {
+            cardSerial++;
+        }
+        cardPresent = present;
+    }
+
+    void setSDCost(unsigned long callMicros, unsigned long byteNanos, unsigned long sectorMicros) {
+        callCost = callMicros;
+        byteCost = byteNanos;
+        sectorCost = sectorMicros;
+    }
+
+    void setSDInitCost(unsigned long initMicros) {
+        initCost = initMicros;
+    }
+
+    unsigned long long getSDMicros() {
+        return spentMicros;
+    }
+
+    unsigned long getSDCalls() {
+        return calls;
+    }
+}
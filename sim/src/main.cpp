@@ -0,0 +1,591 @@
+/**
+ * @file main.cpp
+ * @brief Host replay of a drawing through RobusDraw.
+ *
+ * Usage: program <drawing file> [--precision value] [--loop-us value] [--max-time-s value] [--simplify factor] [--hysteresis value] [--planning] [--pipelined] [--resume-at point] [--power-loss-s value] [--sd-poll-ms value] [--scheduler] [--bench-read] [--encoder-replay]
+ *
+ * The drawing is mounted on the simulated card and driven through the same
+ * refresh/update sequence as the robot's loop(), with a simulated clock.
+ * The host cost of every update() call is measured as well, in nanoseconds
+ * and, on x86, in time stamp counter cycles; build the native_fixed
+ * environment to compare the fixed-point coordinates with the float ones.
+ * The native_profiling environment also prints the loop profile, in
+ * simulated microseconds.
+ *
+ * The point index of a text drawing is mounted with it when it exists next
+ * to it on the host. --resume-at starts the drawing at a point with
+ * resumeDrawing() and reports what the seek cost on the card. A point that
+ * cannot be found is reported and the drawing is drawn from its start, so
+ * the replay shows that the failed seek left the prefetch consistent.
+ *
+ * Checkpoints are saved on the simulated card while drawing. --power-loss-s
+ * cuts the power at that time: the robot is put back on the pose of the
+ * checkpoint, as the robot asks for, its odometry starts over from there,
+ * and the drawing is resumed from the checkpoint.
+ *
+ * --pipelined turns the carousel and moves the pencil while the robot
+ * travels between strokes, see RobusDraw::setPencilPipelining(). The replay
+ * then fails if the robot waits at the end of a stroke for longer than the
+ * pencil takes to clear the paper, plus one loop.
+ *
+ * --sd-poll-ms sets how often SDState checks the card; 0 checks it on
+ * every loop like the robot used to.
+ *
+ * The replay runs the control step, SD polling and checkpoints back to back
+ * followed by a --loop-us delay, like the robot's loop() used to. With
+ * --scheduler they run as Scheduler tasks instead, with the control task
+ * released every --loop-us and the prefetch as a background task.
+ *
+ * --bench-read instead streams the file through the per-byte File calls the
+ * text parser used to make and through BufferedFileReader, and reports the
+ * simulated throughput of both.
+ *
+ * --encoder-replay needs no drawing. It replays a synthetic pulse stream on
+ * both encoder counters, reads them every --loop-us with ENCODER_ReadDelta()
+ * and then with read-then-reset, and fails if the deltas lost any pulse.
+ */
+
+#include <Arduino.h>
+#include <SDState.h>
+#include <Checkpoint.h>
+#include <Profiler.h>
+#include <Scheduler.h>
+#include "RobusDraw.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#define SCHEDULER_PASS_MICROS 20
+
+#define ENCODER_REPLAY_SECONDS 600
+// Time between the read and the reset of ENCODER_ReadReset() on the LS7366, its reset waits 100 us
+#define ENCODER_RESET_GAP_MICROS 150
+#define ENCODER_MAX_RATE 8000.0
+#define ENCODER_WRAP_MARGIN 100000
+
+namespace {
+    struct Options {
+        const char *path = nullptr;
+        float precision = 0.4;
+        unsigned long loopMicros = 2000;
+        float maxTimeSeconds = 3600;
+        float simplification = DRAWING_SIMPLIFY_FACTOR;
+        float hysteresis = DRAWING_WAYPOINT_HYSTERESIS;
+        bool planning = false;
+        bool pipelined = false;
+        int resumeAt = -1;
+        float powerLossSeconds = -1;
+        unsigned long sdPollMillis = SD_POLL_PERIOD;
+        bool scheduler = false;
+        bool benchRead = false;
+        bool encoderReplay = false;
+    };
+
+    struct Report {
+        unsigned long iterations = 0;
+        float drawnDistance = 0;
+        float travelDistance = 0;
+        unsigned long maxUpdateMicros = 0;
+        double updateNanos = 0;
+        unsigned long long updateCycles = 0;
+        double wallSeconds = 0;
+
+        RobusPosition::Vector last = {};
+        unsigned long lastControlMicros = 0;
+        unsigned long minControlInterval = ULONG_MAX;
+        unsigned long maxControlInterval = 0;
+
+        uint8_t lastPencilAngle = PENCIL_UP_ANGLE;
+        bool lifting = false; /**< The pencil left the paper and the robot did not move since. */
+        unsigned long liftMicros = 0;
+        unsigned long lifts = 0;
+        unsigned long maxLiftWaitMicros = 0;
+    };
+
+    unsigned long long readCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    void onSDStateChange(SDState::SDState state) {
+        (void) state;
+    }
+
+    bool parseOptions(int argc, char **argv, Options &options) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+
+            if (arg == "--precision" && hasValue) {
+                options.precision = atof(argv[++i]);
+            } else if (arg == "--loop-us" && hasValue) {
+                options.loopMicros = strtoul(argv[++i], nullptr, 10);
+            } else if (arg == "--max-time-s" && hasValue) {
+                options.maxTimeSeconds = atof(argv[++i]);
+            } else if (arg == "--simplify" && hasValue) {
+                options.simplification = atof(argv[++i]);
+            } else if (arg == "--hysteresis" && hasValue) {
+                options.hysteresis = atof(argv[++i]);
+            } else if (arg == "--planning") {
+                options.planning = true;
+            } else if (arg == "--pipelined") {
+                options.pipelined = true;
+            } else if (arg == "--resume-at" && hasValue) {
+                options.resumeAt = atoi(argv[++i]);
+            } else if (arg == "--power-loss-s" && hasValue) {
+                options.powerLossSeconds = atof(argv[++i]);
+            } else if (arg == "--sd-poll-ms" && hasValue) {
+                options.sdPollMillis = strtoul(argv[++i], nullptr, 10);
+            } else if (arg == "--scheduler") {
+                options.scheduler = true;
+            } else if (arg == "--bench-read") {
+                options.benchRead = true;
+            } else if (arg == "--encoder-replay") {
+                options.encoderReplay = true;
+            } else if (arg[0] != '-' && options.path == nullptr) {
+                options.path = argv[i];
+            } else {
+                return false;
+            }
+        }
+        return options.path != nullptr || options.encoderReplay;
+    }
+
+    bool mountFile(const char *hostPath, char *cardName, size_t size) {
+        std::ifstream input(hostPath, std::ios::binary);
+        if (!input) {
+            return false;
+        }
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+        std::string name = hostPath;
+        size_t slash = name.find_last_of("/\\");
+        if (slash != std::string::npos) {
+            name = name.substr(slash + 1);
+        }
+        snprintf(cardName, size, "%s", name.c_str());
+
+        Sim::mountFile(cardName, data);
+        return true;
+    }
+
+    bool mountDrawing(const char *hostPath, char *cardName, size_t size) {
+        if (!mountFile(hostPath, cardName, size)) {
+            return false;
+        }
+
+        char indexPath[256];
+        char indexName[64];
+        RobusDraw::indexPathFor(hostPath, indexPath, sizeof(indexPath));
+        if (mountFile(indexPath, indexName, sizeof(indexName))) {
+            printf("index            %s\n", indexName);
+        }
+        return true;
+    }
+
+    double throughput(unsigned long bytes, unsigned long micros) {
+        return micros > 0 ? bytes * 1000000.0 / micros : 0;
+    }
+
+    /**
+     * @brief Streams a file byte by byte with a read() and an available() call per byte, like getFileNextLine() used to.
+     */
+    void benchmarkByteReads(const char *cardName) {
+        File file = SD.open(cardName);
+        unsigned long calls = Sim::getSDCalls();
+        unsigned long start = micros();
+        unsigned long bytes = 0;
+
+        while (file.available()) {
+            file.read();
+            bytes++;
+        }
+
+        unsigned long elapsed = micros() - start;
+        printf("per-byte reads   %lu bytes, %lu calls, %.0f bytes/s\n", bytes, Sim::getSDCalls() - calls, throughput(bytes, elapsed));
+        file.close();
+    }
+
+    /**
+     * @brief Streams a file through BufferedFileReader.
+     */
+    void benchmarkBufferedReads(const char *cardName) {
+        File file = SD.open(cardName);
+        BufferedFileReader reader;
+        reader.attach(&file);
+        unsigned long calls = Sim::getSDCalls();
+        unsigned long start = micros();
+        unsigned long bytes = 0;
+
+        while (reader.read() >= 0) {
+            bytes++;
+        }
+
+        unsigned long elapsed = micros() - start;
+        printf("buffered reads   %lu bytes, %lu calls, %.0f bytes/s (%d byte buffer)\n", bytes, Sim::getSDCalls() - calls, throughput(bytes, elapsed), DRAWING_READ_BUFFER_SIZE);
+        file.close();
+    }
+
+    /**
+     * @brief Generates the pulses of both wheels over a control period, the same on every replay.
+     */
+    class PulseStream {
+        public:
+            /**
+             * @brief Moves the wheels for some time.
+             * @param micros The duration in microseconds.
+             * @param pulses Receives the pulses of each wheel.
+             */
+            void advance(unsigned long micros, int32_t pulses[2]) {
+                for (uint8_t id = 0; id < 2; id++) {
+                    double before = floor(position[id]);
+                    position[id] += rate[id] * micros / 1000000.0;
+                    pulses[id] = (int32_t) (floor(position[id]) - before);
+                    total[id] += pulses[id];
+                }
+            }
+
+            /**
+             * @brief Changes the speed of the wheels at random, mostly forward with some reversing.
+             */
+            void accelerate() {
+                for (uint8_t id = 0; id < 2; id++) {
+                    rate[id] = std::min(std::max(rate[id] + change(generator), -0.25 * ENCODER_MAX_RATE), ENCODER_MAX_RATE);
+                }
+            }
+
+            double rate[2] = {0, 0}; /**< Pulses per second. */
+            long long total[2] = {0, 0};
+
+        private:
+            std::mt19937 generator{1};
+            std::uniform_real_distribution<double> change{-200, 200};
+            double position[2] = {0, 0};
+    };
+
+    /**
+     * @brief Replays the pulse stream and counts it with ENCODER_ReadDelta() or read-then-reset.
+     * @param loopMicros The time between two reads.
+     * @param delta True to count with ENCODER_ReadDelta(), false with ENCODER_Read() then ENCODER_Reset().
+     * @param counted Receives the pulses counted on each wheel.
+     * @param pulses Receives the pulses that happened on each wheel.
+     */
+    void replayEncoders(unsigned long loopMicros, bool delta, long long counted[2], long long pulses[2]) {
+        PulseStream stream;
+        int32_t step[2];
+
+        // The right counter counts backward like on the robot, both start close to the wraparound they head to
+        Sim::setEncoderCount(LEFT, delta ? INT32_MAX - ENCODER_WRAP_MARGIN : 0);
+        Sim::setEncoderCount(RIGHT, delta ? INT32_MIN + ENCODER_WRAP_MARGIN : 0);
+
+        // Deltas count from the counters as BoardInit finds them, not from zero
+        BoardInit();
+        counted[LEFT] = 0;
+        counted[RIGHT] = 0;
+
+        unsigned long steps = ENCODER_REPLAY_SECONDS * 1000000UL / loopMicros;
+        for (unsigned long i = 0; i < steps; i++) {
+            stream.accelerate();
+
+            stream.advance(loopMicros - ENCODER_RESET_GAP_MICROS, step);
+            for (uint8_t id = 0; id < 2; id++) {
+                Sim::addEncoderPulses(id, id == LEFT ? step[id] : -step[id]);
+                counted[id] += delta ? ENCODER_ReadDelta(id) : ENCODER_Read(id);
+            }
+
+            // Pulses arriving between the read and the reset
+            stream.advance(ENCODER_RESET_GAP_MICROS, step);
+            for (uint8_t id = 0; id < 2; id++) {
+                Sim::addEncoderPulses(id, id == LEFT ? step[id] : -step[id]);
+                if (!delta) {
+                    ENCODER_Reset(id);
+                }
+            }
+        }
+
+        for (uint8_t id = 0; id < 2; id++) {
+            counted[id] += delta ? ENCODER_ReadDelta(id) : ENCODER_Read(id);
+            pulses[id] = id == LEFT ? stream.total[id] : -stream.total[id];
+        }
+    }
+
+    /**
+     * @brief Checks that ENCODER_ReadDelta() counts every pulse of a long synthetic run, across the counter wraparound.
+     * @param loopMicros The time between two reads.
+     * @return True if no pulse was lost, false otherwise.
+     */
+    bool checkEncoderDeltas(unsigned long loopMicros) {
+        long long pulses[2];
+        long long delta[2];
+        long long readReset[2];
+        replayEncoders(loopMicros, true, delta, pulses);
+        replayEncoders(loopMicros, false, readReset, pulses);
+
+        long long deltaLost = llabs(pulses[LEFT] - delta[LEFT]) + llabs(pulses[RIGHT] - delta[RIGHT]);
+        long long readResetLost = llabs(pulses[LEFT] - readReset[LEFT]) + llabs(pulses[RIGHT] - readReset[RIGHT]);
+
+        printf("encoder replay   %d s, read every %lu us, counters started %d pulses from the wraparound\n", ENCODER_REPLAY_SECONDS, loopMicros, ENCODER_WRAP_MARGIN);
+        printf("pulses           left %lld, right %lld\n", pulses[LEFT], pulses[RIGHT]);
+        printf("read-delta       left %lld, right %lld, %lld lost\n", delta[LEFT], delta[RIGHT], deltaLost);
+        printf("read-reset       left %lld, right %lld, %lld lost\n", readReset[LEFT], readReset[RIGHT], readResetLost);
+        return deltaLost == 0;
+    }
+
+    /**
+     * @brief Runs one control step and accounts for how far the robot moved.
+     * @param drawing The part of the step that is timed: RobusDraw::update() or RobusDraw::updateDrawing().
+     */
+    void controlStep(Report &report, void (*drawing)()) {
+        unsigned long updateStart = micros();
+        if (report.iterations > 0) {
+            unsigned long interval = updateStart - report.lastControlMicros;
+            report.maxControlInterval = std::max(report.maxControlInterval, interval);
+            report.minControlInterval = std::min(report.minControlInterval, interval);
+        }
+        report.lastControlMicros = updateStart;
+
+        auto hostStart = std::chrono::steady_clock::now();
+        unsigned long long cycleStart = readCycles();
+        {
+            PROFILE_SECTION("draw");
+            drawing();
+        }
+        report.updateCycles += readCycles() - cycleStart;
+        report.updateNanos += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - hostStart).count();
+        unsigned long updateMicros = micros() - updateStart;
+        if (updateMicros > report.maxUpdateMicros) {
+            report.maxUpdateMicros = updateMicros;
+        }
+
+        RobusPosition::Vector position = RobusDraw::getDrawingPosition();
+        float step = dist(report.last.x, report.last.y, position.x, position.y);
+        if (Sim::getServoAngle(PENCIL_DOWN_SERVO) == PENCIL_DOWN_ANGLE) {
+            report.drawnDistance += step;
+        } else {
+            report.travelDistance += step;
+        }
+        report.last = position;
+        report.iterations++;
+
+        // How long the robot stays put once the pencil starts leaving the paper
+        uint8_t pencilAngle = Sim::getServoAngle(PENCIL_DOWN_SERVO);
+        if (report.lastPencilAngle == PENCIL_DOWN_ANGLE && pencilAngle != PENCIL_DOWN_ANGLE) {
+            report.lifting = true;
+            report.liftMicros = updateStart;
+        } else if (report.lifting && step > 0) {
+            report.lifting = false;
+            report.lifts++;
+            report.maxLiftWaitMicros = std::max(report.maxLiftWaitMicros, updateStart - report.liftMicros);
+        }
+        report.lastPencilAngle = pencilAngle;
+    }
+
+    /**
+     * @brief Runs the loop the robot used to have: everything back to back, then a fixed delay.
+     */
+    void replayLoop(const Options &options, unsigned long maxTime, Report &report) {
+        while (!RobusDraw::isDrawingFinished() && millis() < maxTime) {
+            {
+                PROFILE_SECTION("sd");
+                SDState::refresh();
+            }
+
+            controlStep(report, RobusDraw::update);
+
+            {
+                PROFILE_SECTION("checkpoint");
+                Checkpoint::update();
+            }
+
+            Sim::advanceMicros(options.loopMicros);
+        }
+    }
+
+    Report *scheduledReport = nullptr;
+
+    void controlTask() {
+        controlStep(*scheduledReport, RobusDraw::updateDrawing);
+        RobusPosition::update();
+    }
+
+    void prefetchTask() {
+        RobusDraw::updatePrefetch();
+    }
+
+    void sdTask() {
+        PROFILE_SECTION("sd");
+        SDState::refresh();
+    }
+
+    void checkpointTask() {
+        PROFILE_SECTION("checkpoint");
+        Checkpoint::update();
+    }
+
+    /**
+     * @brief Runs the same work as tasks of the scheduler, with the control task every --loop-us.
+     */
+    void replayScheduled(const Options &options, unsigned long maxTime, Report &report) {
+        if (Scheduler::getTaskCount() == 0) {
+            Scheduler::addTask("control", controlTask, options.loopMicros, 0);
+            Scheduler::addTask("prefetch", prefetchTask, options.loopMicros, 1);
+            Scheduler::addTask("checkpoint", checkpointTask, 100000, 2);
+            Scheduler::addTask("sd", sdTask, 10000, 3);
+        }
+        scheduledReport = &report;
+
+        // The simulated clock only moves on SD calls, so every pass is charged a little time
+        while (!RobusDraw::isDrawingFinished() && millis() < maxTime) {
+            Scheduler::run();
+            Sim::advanceMicros(SCHEDULER_PASS_MICROS);
+        }
+    }
+
+    void replay(const Options &options, unsigned long maxTime, Report &report) {
+        auto start = std::chrono::steady_clock::now();
+        report.last = RobusDraw::getDrawingPosition();
+
+        if (options.scheduler) {
+            replayScheduled(options, maxTime, report);
+        } else {
+            replayLoop(options, maxTime, report);
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        report.wallSeconds += std::chrono::duration<double>(end - start).count();
+    }
+
+    /**
+     * @brief Cuts the power of the robot and resumes the drawing from the last checkpoint, like a reboot would.
+     * @return True if the drawing resumed, false otherwise.
+     */
+    bool powerCycle() {
+        Checkpoint::CheckpointRecord record;
+        RobusDraw::stopDrawing();
+        Sim::setPose(0, 0, 0);
+
+        if (!Checkpoint::begin() || !Checkpoint::load(record)) {
+            return false;
+        }
+
+        printf("checkpoint       %s point %ld at (%.2f, %.2f), sequence %lu\n", record.drawingName, (long) record.pointIndex, record.x, record.y, (unsigned long) record.sequence);
+        return Checkpoint::resume(record);
+    }
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        fprintf(stderr, "usage: %s <drawing file> [--precision value] [--loop-us value] [--max-time-s value] [--simplify factor] [--hysteresis value] [--planning] [--pipelined] [--resume-at point] [--power-loss-s value] [--sd-poll-ms value] [--scheduler] [--bench-read] [--encoder-replay]\n", argv[0]);
+        return 2;
+    }
+
+    if (options.encoderReplay) {
+        return checkEncoderDeltas(options.loopMicros) ? 0 : 1;
+    }
+
+    char cardName[64];
+    if (!mountDrawing(options.path, cardName, sizeof(cardName))) {
+        fprintf(stderr, "cannot read %s\n", options.path);
+        return 2;
+    }
+
+    if (options.benchRead) {
+        benchmarkByteReads(cardName);
+        benchmarkBufferedReads(cardName);
+        return 0;
+    }
+
+    SDState::setListener(onSDStateChange);
+    SDState::registerCard(10);
+    SDState::setPollPeriod(options.sdPollMillis);
+    SDState::refresh();
+    Checkpoint::begin();
+
+    RobusDraw::initialize();
+    RobusDraw::setPrecision(options.precision);
+    RobusDraw::setSimplification(options.simplification);
+    RobusDraw::setFollowVelocity(6);
+    RobusDraw::setMotionPlanning(options.planning);
+    RobusDraw::setPencilPipelining(options.pipelined);
+    RobusDraw::setWaypointHysteresis(options.hysteresis);
+
+    if (!RobusDraw::loadDrawing(cardName)) {
+        return 1;
+    }
+    if (options.resumeAt >= 0) {
+        unsigned long sdMicros = Sim::getSDMicros();
+        unsigned long sdCalls = Sim::getSDCalls();
+        if (RobusDraw::resumeDrawing(options.resumeAt)) {
+            printf("resume seek      point %d, %.3f ms sd time in %lu calls\n", options.resumeAt, (Sim::getSDMicros() - sdMicros) / 1000.0, Sim::getSDCalls() - sdCalls);
+        } else {
+            printf("resume seek      point %d not found, drawing from the start\n", options.resumeAt);
+            RobusDraw::startDrawing();
+        }
+    } else {
+        RobusDraw::startDrawing();
+    }
+
+    Report report;
+    unsigned long maxTime = options.maxTimeSeconds * 1000;
+    if (options.powerLossSeconds >= 0) {
+        replay(options, options.powerLossSeconds * 1000, report);
+        if (!powerCycle()) {
+            fprintf(stderr, "no checkpoint to resume\n");
+            return 1;
+        }
+    }
+    replay(options, maxTime, report);
+
+    printf("drawing          %s\n", cardName);
+    printf("points           %d\n", RobusDraw::getDrawingSize());
+    printf("finished         %s\n", RobusDraw::isDrawingFinished() ? "yes" : "no");
+    printf("simulated time   %.3f s\n", millis() / 1000.0);
+    printf("loop iterations  %lu\n", report.iterations);
+    printf("sd time          %.3f s in %lu calls\n", Sim::getSDMicros() / 1000000.0, Sim::getSDCalls());
+    printf("max update time  %lu us\n", report.maxUpdateMicros);
+    printf("control period   %lu to %lu us\n", report.minControlInterval, report.maxControlInterval);
+    if (options.scheduler) {
+        printf("scheduler        %lu missed releases\n", Scheduler::getMisses());
+        Scheduler::dump(Serial);
+    }
+    SDState::PollStats polls = SDState::getPollStats();
+    printf("sd polls         %lu polls, %.0f us average, %lu us max\n", polls.polls, polls.polls > 0 ? (double) polls.totalMicros / polls.polls : 0, polls.maxMicros);
+    printf("prefetch         %u queued, %lu underruns\n", RobusDraw::getPrefetchDepth(), RobusDraw::getPrefetchUnderruns());
+    printf("pass-throughs    %lu points\n", RobusDraw::getWaypointPassThroughs());
+    printf("simplified       %lu points skipped\n", RobusDraw::getSimplifiedPoints());
+    printf("drawn distance   %.2f\n", report.drawnDistance);
+    printf("travel distance  %.2f\n", report.travelDistance);
+    printf("color changes    %lu\n", Sim::getServoMoves(PENCIL_COLOR_SERVO));
+    unsigned long clearMillis = ServoMotion::travelTime(abs(PENCIL_HOVER_ANGLE - PENCIL_DOWN_ANGLE), PENCIL_DOWN_SPEED, PENCIL_DOWN_ACCELERATION);
+    printf("stroke ends      %lu lifts, %.1f ms longest wait, %lu ms to clear the paper\n", report.lifts, report.maxLiftWaitMicros / 1000.0, clearMillis);
+    printf("checkpoints      %lu writes\n", Checkpoint::getWrites());
+#ifdef ROBUS_DRAW_FIXED_POINT
+    const char *arithmetic = "fixed-point";
+#else
+    const char *arithmetic = "float";
+#endif
+    unsigned long iterations = report.iterations > 0 ? report.iterations : 1;
+    printf("update cost      %.0f ns, %.0f cycles per call (host, %s coordinates)\n", report.updateNanos / iterations, (double) report.updateCycles / iterations, arithmetic);
+    printf("wall time        %.3f ms\n", report.wallSeconds * 1000.0);
+    PROFILE_DUMP(Serial);
+
+    if (options.pipelined && report.maxLiftWaitMicros > clearMillis * 1000 + options.loopMicros) {
+        fprintf(stderr, "the robot waited for more than the pencil clearing the paper at the end of a stroke\n");
+        return 1;
+    }
+    return RobusDraw::isDrawingFinished() ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file BufferedFileReader.cpp
+ * @brief Ring buffer in front of an SD File, so the parsers read from RAM instead of making one library call per byte.
+ */
+
+#include "BufferedFileReader.h"
+
+/**
+ * @brief Binds the reader to a file and drops any buffered data.
+ * @param _file The file to read from. It must outlive the reader or be attached again.
+ */
+void BufferedFileReader::attach(File* _file) {
+    file = _file;
+    head = 0;
+    count = 0;
+}
+
+/**
+ * @brief Tops up the buffer with a single block read from the file.
+ *
+ * Only the contiguous free space after the buffered data is filled, so a
+ * call never costs more than one File::read(buf, n).
+ *
+ * @return The number of bytes added to the buffer.
+ */
+int BufferedFileReader::fill() {
+    if (file == nullptr || count == DRAWING_READ_BUFFER_SIZE) {
+        return 0;
+    }
+
+    if (count == 0) {
+        head = 0;
+    }
+
+    uint16_t tail = head + count;
+    if (tail >= DRAWING_READ_BUFFER_SIZE) {
+        tail -= DRAWING_READ_BUFFER_SIZE;
+    }
+    uint16_t space = tail >= head ? DRAWING_READ_BUFFER_SIZE - tail : head - tail;
+
+    int received = file->read(buffer + tail, space);
+    if (received <= 0) {
+        return 0;
+    }
+
+    count += received;
+    return received;
+}
+
+/**
+ * @brief Reads a single byte.
+ * @return The byte read, or -1 at the end of the file.
+ */
+int BufferedFileReader::read() {
+    if (count == 0 && fill() == 0) {
+        return -1;
+    }
+
+    uint8_t c = buffer[head];
+    if (++head == DRAWING_READ_BUFFER_SIZE) {
+        head = 0;
+    }
+    count--;
+
+    return c;
+}
+
+/**
+ * @brief Reads a block of bytes.
+ * @param destination The array receiving the bytes.
+ * @param size The number of bytes to read.
+ * @return The number of bytes read, smaller than size only at the end of the file.
+ */
+int BufferedFileReader::read(uint8_t* destination, int size) {
+    int copied = 0;
+
+    while (copied < size) {
+        if (count == 0 && fill() == 0) {
+            break;
+        }
+
+        uint16_t chunk = DRAWING_READ_BUFFER_SIZE - head;
+        if (chunk > count) {
+            chunk = count;
+        }
+        if (chunk > size - copied) {
+            chunk = size - copied;
+        }
+
+        memcpy(destination + copied, buffer + head, chunk);
+        copied += chunk;
+        count -= chunk;
+        head += chunk;
+        if (head == DRAWING_READ_BUFFER_SIZE) {
+            head = 0;
+        }
+    }
+
+    return copied;
+}
+
+/**
+ * @brief Reads up to the next line feed. Characters that do not fit in the array are skipped.
+ * @param line The array receiving the null-terminated line, without its line feed.
+ * @param size The size of the array.
+ * @return The length of the line, or -1 if the end of the file was reached before any character.
+ */
+int BufferedFileReader::readLine(char* line, int size) {
+    int length = 0;
+    int c = read();
+
+    if (c < 0) {
+        line[0] = '\0';
+        return -1;
+    }
+
+    while (c >= 0 && c != '\n') {
+        if (length < size - 1) {
+            line[length++] = c;
+        }
+        c = read();
+    }
+
+    line[length] = '\0';
+    return length;
+}
+
+/**
+ * @brief Retrieves the number of bytes left, buffered or not.
+ * @return The number of bytes that can still be read.
+ */
+int BufferedFileReader::available() {
+    return count + (file != nullptr ? file->available() : 0);
+}
+
+/**
+ * @brief Moves to a position in the file, dropping the buffered data.
+ * @param position The offset from the start of the file.
+ * @return True if the position is valid, false otherwise.
+ */
+bool BufferedFileReader::seek(uint32_t position) {
+    head = 0;
+    count = 0;
+    return file != nullptr && file->seek(position);
+}
+
+/**
+ * @brief Retrieves the position of the next byte that will be served.
+ * @return The offset from the start of the file.
+ */
+uint32_t BufferedFileReader::position() {
+    return file != nullptr ? file->position() - count : 0;
+}
@@ -0,0 +1,32 @@
+#ifndef BUFFERED_FILE_READER_H
+#define BUFFERED_FILE_READER_H
+
+#include <Arduino.h>
+#include <SD.h>
+
+#ifndef DRAWING_READ_BUFFER_SIZE
+#define DRAWING_READ_BUFFER_SIZE 128
+#endif
+
+class BufferedFileReader {
+    public:
+        void attach(File* file);
+
+        int read();
+        int read(uint8_t* destination, int size);
+        int readLine(char* line, int size);
+
+        int available();
+        bool seek(uint32_t position);
+        uint32_t position();
+
+        int fill();
+
+    private:
+        File* file = nullptr;
+        uint8_t buffer[DRAWING_READ_BUFFER_SIZE];
+        uint16_t head = 0; /**< Index of the next byte to serve. */
+        uint16_t count = 0; /**< Number of buffered bytes not served yet. */
+};
+
+#endif // BUFFERED_FILE_READER_H
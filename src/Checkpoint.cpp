@@ -0,0 +1,417 @@
+/**
+ * @file Checkpoint.cpp
+ * @brief Saves the progress of the running drawing on the SD card, so it can be resumed after a power loss.
+ *
+ * CHECKPOINT_FILE holds CHECKPOINT_SLOTS slots, CHECKPOINT_SLOT_STRIDE bytes
+ * apart so that each one sits in its own sector. Every save goes to the
+ * slot after the previous one, which spreads the writes over the sectors
+ * and leaves the previous save intact if the power goes during a write.
+ * The slot with the highest valid sequence number is the current one.
+ *
+ * A periodic save runs from the scheduler while the robot drives, so it is
+ * spread over several updates: the record is encoded in one, then the seek,
+ * the write into the sector cache and the flush of the sector each get an
+ * update of their own. No update of the checkpoint task does more than one
+ * sector transfer, which bounds the delay it adds to the control task.
+ *
+ * The point is the last one the robot reached and the pose, pencil color
+ * and inLine flag are the ones the robot had in the drawing's frame when it
+ * reached it, so resuming from that pose draws on from that point exactly.
+ *
+ * Each slot starts with a record of CHECKPOINT_RECORD_SIZE bytes, little-endian:
+ *
+ * | Offset | Size | Field                                        |
+ * |--------|------|----------------------------------------------|
+ * | 0      | 4    | Magic number "RDCK"                          |
+ * | 4      | 1    | Record version                               |
+ * | 5      | 1    | Flags: bit 0 active, bit 1 inLine            |
+ * | 6      | 1    | PencilColor                                  |
+ * | 7      | 1    | Reserved                                     |
+ * | 8      | 4    | Sequence number                              |
+ * | 12     | 4    | Index of the point reached (int32)           |
+ * | 16     | 12   | Pose: x, y, orientation (float)              |
+ * | 28     | 13   | 8.3 name of the drawing file                 |
+ * | 41     | 1    | Reserved                                     |
+ * | 42     | 2    | CRC-16/CCITT of bytes 0 to 41                |
+ */
+
+#include "Checkpoint.h"
+#include "RobusDraw.h"
+
+namespace Checkpoint {
+
+    /**
+     * @brief Opens the checkpoint file, creating its slots if needed.
+     *
+     * Call it once the card is present. Growing the file happens here, so
+     * the saves made while drawing only rewrite existing sectors.
+     *
+     * @return True if the file is ready, false otherwise.
+     */
+    bool begin() {
+        file.close();
+        file = SD.open(CHECKPOINT_FILE, CHECKPOINT_FILE_MODE);
+        if (!file) {
+            return false;
+        }
+
+        uint32_t size = uint32_t(CHECKPOINT_SLOTS) * CHECKPOINT_SLOT_STRIDE;
+        if (file.size() < size) {
+            uint8_t zeros[32] = {0};
+            file.seek(file.size());
+            while (file.size() < size) {
+                uint32_t count = size - file.size();
+                file.write(zeros, count < sizeof(zeros) ? count : sizeof(zeros));
+            }
+            file.flush();
+        }
+
+        last = {};
+        step = IDLE;
+        load(last);
+        return true;
+    }
+
+    /**
+     * @brief Closes the checkpoint file, dropping a save still going on.
+     *
+     * Call it when the card is gone, so nothing is written through the
+     * file until begin() opens it again on the next card.
+     */
+    void end() {
+        step = IDLE;
+        file.close();
+    }
+
+    /**
+     * @brief Saves the progress of the running drawing, at most once per period.
+     *
+     * Nothing is written while the drawing is paused or when it did not
+     * move on since the last save. A finished drawing is marked as such
+     * once, so it is not offered for resuming. A save takes four calls,
+     * see continueSave().
+     */
+    void update() {
+        if (!file) {
+            return;
+        }
+
+        if (step != IDLE) {
+            continueSave();
+            return;
+        }
+
+        if (!RobusDraw::isDrawingLoaded()) {
+            return;
+        }
+
+        if (RobusDraw::isDrawingFinished()) {
+            if (last.active) {
+                clear();
+            }
+            return;
+        }
+
+        unsigned long now = millis();
+        if (!RobusDraw::isDrawingRunning() || now - lastWriteTime < period) {
+            return;
+        }
+
+        CheckpointRecord record = capture(true);
+        if (last.active && record.pointIndex == last.pointIndex && strcmp(record.drawingName, last.drawingName) == 0) {
+            return;
+        }
+
+        lastWriteTime = now;
+        stage(record);
+    }
+
+    /**
+     * @brief Checks if a save started by update() is still going on.
+     * @return True until the record is flushed to the card, false otherwise.
+     */
+    bool isSaving() {
+        return step != IDLE;
+    }
+
+    /**
+     * @brief Reads the most recent checkpoint.
+     * @param record Receives the checkpoint, whether it is active or not.
+     * @return True if a drawing can be resumed from the checkpoint, false otherwise.
+     */
+    bool load(CheckpointRecord& record) {
+        if (!file) {
+            return false;
+        }
+
+        bool found = false;
+        for (uint8_t slot = 0; slot < CHECKPOINT_SLOTS; slot++) {
+            uint8_t buffer[CHECKPOINT_RECORD_SIZE];
+            CheckpointRecord candidate;
+
+            if (!file.seek(uint32_t(slot) * CHECKPOINT_SLOT_STRIDE)
+                || file.read(buffer, CHECKPOINT_RECORD_SIZE) != CHECKPOINT_RECORD_SIZE
+                || !decodeRecord(buffer, candidate)) {
+                continue;
+            }
+
+            if (!found || candidate.sequence > record.sequence) {
+                record = candidate;
+                found = true;
+            }
+        }
+
+        return found && record.active;
+    }
+
+    /**
+     * @brief Loads the drawing of a checkpoint and resumes it where it was saved.
+     *
+     * The odometry starts over from wherever the robot stands, so the robot
+     * must first be put back on the saved pose: on the point of the
+     * checkpoint, with the saved heading. The drawing origin is placed from
+     * that pose, and whatever was drawn after the save is drawn again.
+     * If the point cannot be found, the drawing is unloaded so it is not
+     * started over from its beginning on top of what was drawn.
+     *
+     * @param record The checkpoint to resume.
+     * @return True if the drawing resumed, false otherwise.
+     */
+    bool resume(const CheckpointRecord& record) {
+        char path[CHECKPOINT_NAME_SIZE];
+        strcpy(path, record.drawingName);
+
+        if (!record.active || !RobusDraw::loadDrawing(path)) {
+            return false;
+        }
+
+        RobusDraw::setDrawingOrigin(record.x, record.y, record.orientation);
+        if (!RobusDraw::resumeDrawing(record.pointIndex)) {
+            RobusDraw::stopDrawing();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Marks the current checkpoint as done, so it is not offered for resuming anymore.
+     *
+     * Written at once, since the robot is stopped by then. A save still
+     * going on is dropped, its slot being the one written here.
+     */
+    void clear() {
+        step = IDLE;
+        CheckpointRecord record = last;
+        record.active = false;
+        write(record);
+    }
+
+    /**
+     * @brief Sets the minimum time between two saves.
+     * @param _period The time in milliseconds.
+     */
+    void setPeriod(unsigned long _period) {
+        period = _period;
+    }
+
+    /**
+     * @brief Retrieves the number of records written since the start.
+     * @return The number of writes.
+     */
+    unsigned long getWrites() {
+        return writes;
+    }
+
+    /**
+     * @brief Encodes a checkpoint record.
+     * @param buffer CHECKPOINT_RECORD_SIZE bytes receiving the record.
+     * @param record The record.
+     */
+    void encodeRecord(uint8_t* buffer, const CheckpointRecord& record) {
+        memset(buffer, 0, CHECKPOINT_RECORD_SIZE);
+        memcpy(buffer, CHECKPOINT_MAGIC, 4);
+        buffer[4] = CHECKPOINT_VERSION;
+        buffer[5] = (record.active ? CHECKPOINT_ACTIVE_FLAG : 0) | (record.inLine ? CHECKPOINT_INLINE_FLAG : 0);
+        buffer[6] = record.color;
+
+        // Both the AVR and the hosts are little-endian with IEEE 754 floats
+        memcpy(buffer + 8, &record.sequence, 4);
+        memcpy(buffer + 12, &record.pointIndex, 4);
+        memcpy(buffer + 16, &record.x, 4);
+        memcpy(buffer + 20, &record.y, 4);
+        memcpy(buffer + 24, &record.orientation, 4);
+        memcpy(buffer + 28, record.drawingName, strlen(record.drawingName));
+
+        uint16_t crc = crc16(buffer, CHECKPOINT_RECORD_SIZE - 2);
+        buffer[42] = crc & 0xFF;
+        buffer[43] = crc >> 8;
+    }
+
+    /**
+     * @brief Decodes a checkpoint record.
+     * @param buffer CHECKPOINT_RECORD_SIZE bytes holding the record.
+     * @param record Receives the record.
+     * @return True if the record is valid, false if the slot is empty or was torn by a power loss.
+     */
+    bool decodeRecord(const uint8_t* buffer, CheckpointRecord& record) {
+        uint16_t crc = buffer[42] | (buffer[43] << 8);
+        if (memcmp(buffer, CHECKPOINT_MAGIC, 4) != 0 || buffer[4] != CHECKPOINT_VERSION
+            || crc != crc16(buffer, CHECKPOINT_RECORD_SIZE - 2)) {
+            return false;
+        }
+
+        record.active = (buffer[5] & CHECKPOINT_ACTIVE_FLAG) != 0;
+        record.inLine = (buffer[5] & CHECKPOINT_INLINE_FLAG) != 0;
+        record.color = (PencilColor) buffer[6];
+
+        memcpy(&record.sequence, buffer + 8, 4);
+        memcpy(&record.pointIndex, buffer + 12, 4);
+        memcpy(&record.x, buffer + 16, 4);
+        memcpy(&record.y, buffer + 20, 4);
+        memcpy(&record.orientation, buffer + 24, 4);
+        memcpy(record.drawingName, buffer + 28, CHECKPOINT_NAME_SIZE - 1);
+        record.drawingName[CHECKPOINT_NAME_SIZE - 1] = '\0';
+
+        return true;
+    }
+
+    namespace {
+        /**
+         * @brief The checkpoint file, kept open so a save is a seek and a single sector write.
+         */
+        File file;
+
+        /**
+         * @brief The minimum time between two saves, in milliseconds.
+         */
+        unsigned long period = CHECKPOINT_PERIOD;
+
+        /**
+         * @brief The time of the last save.
+         */
+        unsigned long lastWriteTime = 0;
+
+        /**
+         * @brief The last record written or found on the card.
+         */
+        CheckpointRecord last = {};
+
+        /**
+         * @brief The number of records written since the start.
+         */
+        unsigned long writes = 0;
+
+        /**
+         * @brief The step the save started by update() is at.
+         */
+        SaveStep step = IDLE;
+
+        /**
+         * @brief The record being saved by update().
+         */
+        CheckpointRecord pending = {};
+
+        /**
+         * @brief The encoded record being saved by update().
+         */
+        uint8_t pendingBuffer[CHECKPOINT_RECORD_SIZE];
+
+        /**
+         * @brief Writes a record in the slot after the last one, all at once.
+         * @param record The record to write. Its sequence number is set here.
+         * @return True if the record was written, false otherwise.
+         */
+        bool write(CheckpointRecord& record) {
+            record.sequence = last.sequence + 1;
+
+            uint8_t buffer[CHECKPOINT_RECORD_SIZE];
+            encodeRecord(buffer, record);
+
+            uint8_t slot = record.sequence % CHECKPOINT_SLOTS;
+            if (!file.seek(uint32_t(slot) * CHECKPOINT_SLOT_STRIDE)
+                || file.write(buffer, CHECKPOINT_RECORD_SIZE) != CHECKPOINT_RECORD_SIZE) {
+                return false;
+            }
+            file.flush();
+
+            last = record;
+            writes++;
+            return true;
+        }
+
+        /**
+         * @brief Starts saving a record in the slot after the last one, without touching the card.
+         * @param record The record to save. Its sequence number is set here.
+         */
+        void stage(const CheckpointRecord& record) {
+            pending = record;
+            pending.sequence = last.sequence + 1;
+            encodeRecord(pendingBuffer, pending);
+            step = ENCODED;
+        }
+
+        /**
+         * @brief Does the next card operation of the save started by stage().
+         *
+         * The record only becomes the last one once its sector is flushed. If
+         * an operation fails the save is dropped and the next period tries again.
+         */
+        void continueSave() {
+            switch (step) {
+                case ENCODED:
+                    step = file.seek(uint32_t(pending.sequence % CHECKPOINT_SLOTS) * CHECKPOINT_SLOT_STRIDE) ? POSITIONED : IDLE;
+                    break;
+                case POSITIONED:
+                    step = file.write(pendingBuffer, CHECKPOINT_RECORD_SIZE) == CHECKPOINT_RECORD_SIZE ? WRITTEN : IDLE;
+                    break;
+                case WRITTEN:
+                    file.flush();
+                    last = pending;
+                    writes++;
+                    step = IDLE;
+                    break;
+                default:
+                    step = IDLE;
+                    break;
+            }
+        }
+
+        /**
+         * @brief Takes the progress of the loaded drawing.
+         * @param active Whether the drawing can be resumed.
+         * @return The record describing the drawing.
+         */
+        CheckpointRecord capture(bool active) {
+            CheckpointRecord record;
+            RobusPosition::Vector position = RobusDraw::getReachedPosition();
+
+            record.active = active;
+            record.pointIndex = RobusDraw::getReachedIndex();
+            record.color = RobusDraw::getReachedColor();
+            record.inLine = RobusDraw::isReachedInLine();
+            record.x = position.x;
+            record.y = position.y;
+            record.orientation = RobusDraw::getReachedOrientation();
+            RobusDraw::getDrawingFileName(record.drawingName);
+
+            return record;
+        }
+
+        /**
+         * @brief Computes the CRC-16/CCITT of a buffer.
+         * @param data The bytes to check.
+         * @param size The number of bytes.
+         * @return The CRC.
+         */
+        uint16_t crc16(const uint8_t* data, uint8_t size) {
+            uint16_t crc = 0xFFFF;
+            for (uint8_t i = 0; i < size; i++) {
+                crc ^= uint16_t(data[i]) << 8;
+                for (uint8_t bit = 0; bit < 8; bit++) {
+                    crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+                }
+            }
+            return crc;
+        }
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <Arduino.h>
+#include <SD.h>
+#include <PencilColor.h>
+
+#define CHECKPOINT_FILE "CHKPT.BIN"
+#define CHECKPOINT_MAGIC "RDCK"
+#define CHECKPOINT_VERSION 2
+#define CHECKPOINT_RECORD_SIZE 44
+#define CHECKPOINT_NAME_SIZE 13
+
+#define CHECKPOINT_ACTIVE_FLAG 0x01
+#define CHECKPOINT_INLINE_FLAG 0x02
+
+// Opened without O_APPEND, which would move every write to the end of the file
+#define CHECKPOINT_FILE_MODE (O_READ | O_WRITE | O_CREAT)
+
+#ifndef CHECKPOINT_SLOTS
+#define CHECKPOINT_SLOTS 4
+#endif
+
+#ifndef CHECKPOINT_SLOT_STRIDE
+#define CHECKPOINT_SLOT_STRIDE 512
+#endif
+
+#ifndef CHECKPOINT_PERIOD
+#define CHECKPOINT_PERIOD 5000
+#endif
+
+namespace Checkpoint {
+
+    /**
+     * @brief Step of a save spread over several updates, one card operation per update.
+     */
+    enum SaveStep {
+        IDLE,
+        ENCODED,
+        POSITIONED,
+        WRITTEN
+    };
+
+    /**
+     * @brief Progress of a drawing, as saved on the card.
+     */
+    struct CheckpointRecord {
+        uint32_t sequence = 0;
+        bool active = false; /**< False once the drawing finished, so there is nothing to resume. */
+        int32_t pointIndex = 0; /**< Last point reached, the pose and pencil state being the ones the robot had there. */
+        PencilColor color = BLACK;
+        bool inLine = false;
+        float x = 0;
+        float y = 0;
+        float orientation = 0;
+        char drawingName[CHECKPOINT_NAME_SIZE] = "";
+    };
+
+    bool begin();
+    void end();
+    void update();
+    bool isSaving();
+
+    bool load(CheckpointRecord& record);
+    bool resume(const CheckpointRecord& record);
+    void clear();
+
+    void setPeriod(unsigned long _period);
+    unsigned long getWrites();
+
+    void encodeRecord(uint8_t* buffer, const CheckpointRecord& record);
+    bool decodeRecord(const uint8_t* buffer, CheckpointRecord& record);
+
+    namespace {
+        extern File file;
+        extern unsigned long period;
+        extern unsigned long lastWriteTime;
+        extern CheckpointRecord last;
+        extern unsigned long writes;
+        extern SaveStep step;
+        extern CheckpointRecord pending;
+        extern uint8_t pendingBuffer[CHECKPOINT_RECORD_SIZE];
+
+        bool write(CheckpointRecord& record);
+        void stage(const CheckpointRecord& record);
+        void continueSave();
+        CheckpointRecord capture(bool active);
+        uint16_t crc16(const uint8_t* data, uint8_t size);
+    }
+}
+
+#endif // CHECKPOINT_H
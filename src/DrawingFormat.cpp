@@ -0,0 +1,283 @@
+/**
+ * @file DrawingFormat.cpp
+ * @brief Encoding and decoding of the compact binary drawing format.
+ *
+ * A binary drawing starts with a fixed-size little-endian header:
+ *
+ * | Offset | Size | Field                                 |
+ * |--------|------|---------------------------------------|
+ * | 0      | 4    | Magic number "RDRW"                   |
+ * | 4      | 1    | Format version                        |
+ * | 5      | 1    | Fractional bits of the coordinates    |
+ * | 6      | 2    | Reserved                              |
+ * | 8      | 20   | DrawingInfo::name                     |
+ * | 28     | 4    | DrawingInfo::width (float)            |
+ * | 32     | 4    | DrawingInfo::height (float)           |
+ * | 36     | 4    | DrawingInfo::pointsCount (int32)      |
+ * | 40     | 4    | followAngularVelocityScale (float)    |
+ * | 44     | 4    | followVelocity (float)                |
+ * | 48     | 4    | curveTightness (float)                |
+ *
+ * It is followed by pointsCount records of 5 bytes: x and y as int16
+ * fixed-point values, then a flags byte holding the PencilColor in its low
+ * nibble and the boundary marker in bit 4.
+ *
+ * A point index can follow the records of a binary drawing, or sit next to
+ * a text drawing in a file with the DRAWING_INDEX_EXTENSION extension:
+ *
+ * | Offset | Size | Field                                 |
+ * |--------|------|---------------------------------------|
+ * | 0      | 4    | Magic number "RDIX"                   |
+ * | 4      | 1    | Index version                         |
+ * | 5      | 1    | Reserved                              |
+ * | 6      | 2    | Interval between indexed points       |
+ * | 8      | 4    | pointsCount of the drawing (int32)    |
+ * | 12     | 4    | Size of the indexed drawing data      |
+ *
+ * Entry k then describes point k * interval in 5 bytes: its byte offset in
+ * the drawing file as a uint32, and a flags byte whose bit 0 holds the pen
+ * state once the point is loaded.
+ */
+
+#include "DrawingFormat.h"
+
+/**
+ * @namespace RobusDraw
+ * @brief Namespace encapsulating functionality for controlling a drawing robot.
+ */
+namespace RobusDraw {
+    namespace {
+        int16_t readInt16(const uint8_t* buffer) {
+            return (int16_t) (buffer[0] | (uint16_t(buffer[1]) << 8));
+        }
+
+        int32_t readInt32(const uint8_t* buffer) {
+            return (int32_t) (uint32_t(buffer[0]) | (uint32_t(buffer[1]) << 8) | (uint32_t(buffer[2]) << 16) | (uint32_t(buffer[3]) << 24));
+        }
+
+        float readFloat(const uint8_t* buffer) {
+            uint32_t bits = readInt32(buffer);
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        void writeInt16(uint8_t* buffer, int16_t value) {
+            buffer[0] = uint16_t(value) & 0xFF;
+            buffer[1] = uint16_t(value) >> 8;
+        }
+
+        void writeInt32(uint8_t* buffer, int32_t value) {
+            for (int i = 0; i < 4; i++) {
+                buffer[i] = (uint32_t(value) >> (8 * i)) & 0xFF;
+            }
+        }
+
+        void writeFloat(uint8_t* buffer, float value) {
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            writeInt32(buffer, bits);
+        }
+
+        int16_t toFixed(float value, uint8_t shift) {
+            float scaled = roundf(ldexpf(value, shift));
+            if (scaled > INT16_MAX) {
+                return INT16_MAX;
+            } else if (scaled < INT16_MIN) {
+                return INT16_MIN;
+            }
+            return (int16_t) scaled;
+        }
+
+        Coordinate fromFixed(int16_t value, uint8_t shift) {
+#ifdef ROBUS_DRAW_FIXED_POINT
+            return Coordinate::fromScaled(value, shift);
+#else
+            return ldexpf(value, -shift);
+#endif
+        }
+    }
+
+    /**
+     * @brief Checks if a buffer starts with the binary drawing magic number.
+     * @param buffer At least DRAWING_BINARY_MAGIC_SIZE bytes read from the start of a file.
+     * @return True if the buffer holds the magic number, false otherwise.
+     */
+    bool isBinaryMagic(const uint8_t* buffer) {
+        return memcmp(buffer, DRAWING_BINARY_MAGIC, DRAWING_BINARY_MAGIC_SIZE) == 0;
+    }
+
+    /**
+     * @brief Decodes the header of a binary drawing.
+     * @param buffer DRAWING_BINARY_HEADER_SIZE bytes read from the start of the file.
+     * @param info Receives the drawing information.
+     * @param settings Receives the drawing settings.
+     * @param layout Receives the layout of the point records.
+     * @return True if the header is valid, false otherwise.
+     */
+    bool decodeBinaryHeader(const uint8_t* buffer, DrawingInfo& info, DrawingSettings& settings, BinaryLayout& layout) {
+        if (!isBinaryMagic(buffer) || buffer[4] != DRAWING_BINARY_VERSION || buffer[5] > 15) {
+            return false;
+        }
+
+        layout.version = buffer[4];
+        layout.coordinateShift = buffer[5];
+
+        memcpy(info.name, buffer + 8, sizeof(info.name));
+        info.name[sizeof(info.name) - 1] = '\0';
+        info.width = readFloat(buffer + 28);
+        info.height = readFloat(buffer + 32);
+        info.pointsCount = readInt32(buffer + 36);
+
+        settings.followAngularVelocityScale = readFloat(buffer + 40);
+        settings.followVelocity = readFloat(buffer + 44);
+        settings.curveTightness = readFloat(buffer + 48);
+
+        return true;
+    }
+
+    /**
+     * @brief Decodes a point record of a binary drawing.
+     * @param record DRAWING_BINARY_RECORD_SIZE bytes holding the record.
+     * @param layout The layout read from the header.
+     * @param point Receives the decoded point.
+     */
+    void decodeBinaryPoint(const uint8_t* record, const BinaryLayout& layout, DrawingPoint& point) {
+        point.x = fromFixed(readInt16(record), layout.coordinateShift);
+        point.y = fromFixed(readInt16(record + 2), layout.coordinateShift);
+        point.color = (PencilColor) (record[4] & DRAWING_RECORD_COLOR_MASK);
+        point.isBoundary = (record[4] & DRAWING_RECORD_BOUNDARY_FLAG) != 0;
+    }
+
+    /**
+     * @brief Encodes the header of a binary drawing.
+     * @param buffer DRAWING_BINARY_HEADER_SIZE bytes receiving the header.
+     * @param info The drawing information.
+     * @param settings The drawing settings.
+     * @param layout The layout of the point records.
+     */
+    void encodeBinaryHeader(uint8_t* buffer, const DrawingInfo& info, const DrawingSettings& settings, const BinaryLayout& layout) {
+        memset(buffer, 0, DRAWING_BINARY_HEADER_SIZE);
+        memcpy(buffer, DRAWING_BINARY_MAGIC, DRAWING_BINARY_MAGIC_SIZE);
+        buffer[4] = layout.version;
+        buffer[5] = layout.coordinateShift;
+
+        memcpy(buffer + 8, info.name, strnlen(info.name, sizeof(info.name) - 1));
+        writeFloat(buffer + 28, info.width);
+        writeFloat(buffer + 32, info.height);
+        writeInt32(buffer + 36, info.pointsCount);
+
+        writeFloat(buffer + 40, settings.followAngularVelocityScale);
+        writeFloat(buffer + 44, settings.followVelocity);
+        writeFloat(buffer + 48, settings.curveTightness);
+    }
+
+    /**
+     * @brief Encodes a point record of a binary drawing.
+     * @param record DRAWING_BINARY_RECORD_SIZE bytes receiving the record.
+     * @param layout The layout of the point records.
+     * @param point The point to encode.
+     */
+    void encodeBinaryPoint(uint8_t* record, const BinaryLayout& layout, const DrawingPoint& point) {
+        writeInt16(record, toFixed(point.x, layout.coordinateShift));
+        writeInt16(record + 2, toFixed(point.y, layout.coordinateShift));
+        record[4] = (point.color & DRAWING_RECORD_COLOR_MASK) | (point.isBoundary ? DRAWING_RECORD_BOUNDARY_FLAG : 0);
+    }
+
+    /**
+     * @brief Finds the finest coordinate resolution that can still hold a magnitude in an int16.
+     * @param maxMagnitude The largest absolute coordinate of the drawing.
+     * @return The number of fractional bits to use.
+     */
+    uint8_t coordinateShiftFor(float maxMagnitude) {
+        uint8_t shift = 0;
+        while (shift < 15 && ldexpf(fabsf(maxMagnitude), shift + 1) <= INT16_MAX) {
+            shift++;
+        }
+        return shift;
+    }
+
+    /**
+     * @brief Parses a coordinate of a text drawing.
+     * @param text The decimal text of the coordinate.
+     * @return The coordinate, parsed without soft-float when ROBUS_DRAW_FIXED_POINT is defined.
+     */
+    Coordinate parseCoordinate(const char* text) {
+#ifdef ROBUS_DRAW_FIXED_POINT
+        return Coordinate::parse(text);
+#else
+        return atof(text);
+#endif
+    }
+
+    /**
+     * @brief Decodes the header of a point index.
+     * @param buffer DRAWING_INDEX_HEADER_SIZE bytes read from the start of the index.
+     * @param header Receives the header.
+     * @return True if the header is valid, false otherwise.
+     */
+    bool decodeIndexHeader(const uint8_t* buffer, IndexHeader& header) {
+        if (memcmp(buffer, DRAWING_INDEX_MAGIC, 4) != 0 || buffer[4] != DRAWING_INDEX_VERSION) {
+            return false;
+        }
+
+        header.interval = (uint16_t) readInt16(buffer + 6);
+        header.pointsCount = readInt32(buffer + 8);
+        header.dataSize = readInt32(buffer + 12);
+
+        return header.interval > 0;
+    }
+
+    /**
+     * @brief Decodes an entry of a point index.
+     * @param record DRAWING_INDEX_ENTRY_SIZE bytes holding the entry.
+     * @param entry Receives the entry.
+     */
+    void decodeIndexEntry(const uint8_t* record, IndexEntry& entry) {
+        entry.offset = readInt32(record);
+        entry.inLine = (record[4] & DRAWING_INDEX_INLINE_FLAG) != 0;
+    }
+
+    /**
+     * @brief Encodes the header of a point index.
+     * @param buffer DRAWING_INDEX_HEADER_SIZE bytes receiving the header.
+     * @param header The header.
+     */
+    void encodeIndexHeader(uint8_t* buffer, const IndexHeader& header) {
+        memset(buffer, 0, DRAWING_INDEX_HEADER_SIZE);
+        memcpy(buffer, DRAWING_INDEX_MAGIC, 4);
+        buffer[4] = DRAWING_INDEX_VERSION;
+
+        writeInt16(buffer + 6, header.interval);
+        writeInt32(buffer + 8, header.pointsCount);
+        writeInt32(buffer + 12, header.dataSize);
+    }
+
+    /**
+     * @brief Encodes an entry of a point index.
+     * @param record DRAWING_INDEX_ENTRY_SIZE bytes receiving the entry.
+     * @param entry The entry.
+     */
+    void encodeIndexEntry(uint8_t* record, const IndexEntry& entry) {
+        writeInt32(record, entry.offset);
+        record[4] = entry.inLine ? DRAWING_INDEX_INLINE_FLAG : 0;
+    }
+
+    /**
+     * @brief Builds the name of the index file of a text drawing by replacing its extension.
+     * @param path The path of the drawing.
+     * @param indexPath Receives the path of the index.
+     * @param size The size of indexPath.
+     */
+    void indexPathFor(const char* path, char* indexPath, size_t size) {
+        const char* dot = strrchr(path, '.');
+        const char* slash = strrchr(path, '/');
+        size_t stem = dot != nullptr && (slash == nullptr || dot > slash) ? dot - path : strlen(path);
+
+        if (stem + strlen(DRAWING_INDEX_EXTENSION) + 1 > size) {
+            stem = size - strlen(DRAWING_INDEX_EXTENSION) - 1;
+        }
+        memcpy(indexPath, path, stem);
+        strcpy(indexPath + stem, DRAWING_INDEX_EXTENSION);
+    }
+}
@@ -0,0 +1,114 @@
+#ifndef DRAWING_FORMAT_H
+#define DRAWING_FORMAT_H
+
+#include <Arduino.h>
+#include <PencilColor.h>
+#include <FixedPoint.h>
+
+#define DRAWING_BINARY_MAGIC "RDRW"
+#define DRAWING_BINARY_VERSION 1
+#define DRAWING_BINARY_MAGIC_SIZE 4
+#define DRAWING_BINARY_HEADER_SIZE 52
+#define DRAWING_BINARY_RECORD_SIZE 5
+// Largest coordinate magnitude of a binary record, an int16 with no fractional bit
+#define DRAWING_BINARY_MAX_COORDINATE 32767
+
+#define DRAWING_RECORD_COLOR_MASK 0x0F
+#define DRAWING_RECORD_BOUNDARY_FLAG 0x10
+
+#define DRAWING_INDEX_MAGIC "RDIX"
+#define DRAWING_INDEX_VERSION 1
+#define DRAWING_INDEX_HEADER_SIZE 16
+#define DRAWING_INDEX_ENTRY_SIZE 5
+#define DRAWING_INDEX_EXTENSION ".IDX"
+
+#define DRAWING_INDEX_INLINE_FLAG 0x01
+
+#ifndef DRAWING_INDEX_INTERVAL
+#define DRAWING_INDEX_INTERVAL 64
+#endif
+
+#ifndef DRAWING_COORDINATE_FRACTION_BITS
+#define DRAWING_COORDINATE_FRACTION_BITS 8
+#endif
+
+namespace RobusDraw {
+
+#ifdef ROBUS_DRAW_FIXED_POINT
+    typedef Fixed<int32_t, int64_t, DRAWING_COORDINATE_FRACTION_BITS> Coordinate;
+#else
+    typedef float Coordinate;
+#endif
+
+    struct DrawingInfo {
+        char name[20];
+        float width;
+        float height;
+        int pointsCount;
+    };
+
+    struct DrawingSettings {
+        float followAngularVelocityScale = NAN; /**< Scale factor for angular velocity when following a target. */
+        float followVelocity = NAN; /**< Velocity at which the robot follows a target. */
+        float curveTightness = NAN; /**< Tightness of the curve when following a target. */
+    };
+
+    struct DrawingPoint {
+        Coordinate x;
+        Coordinate y;
+        PencilColor color;
+        bool isBoundary;
+    };
+
+    /**
+     * @brief Header of a point index, mapping every interval-th point to its place in the drawing file.
+     */
+    struct IndexHeader {
+        uint16_t interval = DRAWING_INDEX_INTERVAL;
+        int32_t pointsCount = 0;
+        uint32_t dataSize = 0; /**< Size of the indexed drawing data, to detect an index left over from another file. */
+    };
+
+    /**
+     * @brief Where a point starts in the drawing file and the pen state once it is loaded.
+     */
+    struct IndexEntry {
+        uint32_t offset;
+        bool inLine;
+    };
+
+    enum DrawingEncoding {
+        TEXT_ENCODING,
+        BINARY_ENCODING
+    };
+
+    /**
+     * @brief Layout of a binary drawing, as stored in its header.
+     */
+    struct BinaryLayout {
+        uint8_t version = DRAWING_BINARY_VERSION;
+        uint8_t coordinateShift = 0; /**< Number of fractional bits of the int16 coordinates. */
+    };
+
+    bool isBinaryMagic(const uint8_t* buffer);
+
+    bool decodeBinaryHeader(const uint8_t* buffer, DrawingInfo& info, DrawingSettings& settings, BinaryLayout& layout);
+    void decodeBinaryPoint(const uint8_t* record, const BinaryLayout& layout, DrawingPoint& point);
+
+    void encodeBinaryHeader(uint8_t* buffer, const DrawingInfo& info, const DrawingSettings& settings, const BinaryLayout& layout);
+    void encodeBinaryPoint(uint8_t* record, const BinaryLayout& layout, const DrawingPoint& point);
+
+    uint8_t coordinateShiftFor(float maxMagnitude);
+
+    Coordinate parseCoordinate(const char* text);
+
+    bool decodeIndexHeader(const uint8_t* buffer, IndexHeader& header);
+    void decodeIndexEntry(const uint8_t* record, IndexEntry& entry);
+
+    void encodeIndexHeader(uint8_t* buffer, const IndexHeader& header);
+    void encodeIndexEntry(uint8_t* record, const IndexEntry& entry);
+
+    void indexPathFor(const char* path, char* indexPath, size_t size);
+}
+
+#endif // DRAWING_FORMAT_H
@@ -0,0 +1,147 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Signed binary fixed-point number with FractionBits fractional bits.
+ *
+ * Additions and comparisons are plain integer operations. Products and
+ * quotients go through the Wide type so they do not overflow before the
+ * rescaling shift. Conversion to float is implicit, so code that only
+ * needs floats keeps compiling when a value turns fixed-point. The
+ * conversion from float is explicit, so soft-float stays visible in the
+ * source.
+ *
+ * @tparam Storage Signed integer type holding the raw value.
+ * @tparam Wide Signed integer type at least twice as wide as Storage.
+ * @tparam FractionBits Number of fractional bits.
+ */
+template <typename Storage, typename Wide, uint8_t FractionBits>
+class Fixed {
+    public:
+        static const Storage ONE = Storage(1) << FractionBits;
+
+        Fixed() : value(0) {}
+        explicit Fixed(int integer) : value(Storage(integer) * ONE) {}
+        explicit Fixed(float real) : value(Storage(real * ONE + (real < 0 ? -0.5f : 0.5f))) {}
+
+        static Fixed fromRaw(Storage raw) {
+            Fixed fixed;
+            fixed.value = raw;
+            return fixed;
+        }
+
+        /**
+         * @brief Converts an integer with another number of fractional bits, rounding to the nearest value.
+         * @param raw The integer to convert.
+         * @param bits The number of fractional bits of the integer.
+         * @return The converted value.
+         */
+        static Fixed fromScaled(Storage raw, uint8_t bits) {
+            if (bits <= FractionBits) {
+                return fromRaw(raw * (Storage(1) << (FractionBits - bits)));
+            }
+            uint8_t shift = bits - FractionBits;
+            return fromRaw((raw + (Storage(1) << (shift - 1))) >> shift);
+        }
+
+        /**
+         * @brief Parses a decimal number such as "-12.375" without going through float.
+         * @param text The text to parse. Parsing stops at the first character that is not part of the number.
+         * @return The parsed value, rounded to the nearest representable one.
+         */
+        static Fixed parse(const char* text) {
+            while (*text == ' ') {
+                text++;
+            }
+
+            bool negative = *text == '-';
+            if (*text == '-' || *text == '+') {
+                text++;
+            }
+
+            Storage integer = 0;
+            while (*text >= '0' && *text <= '9') {
+                integer = integer * 10 + (*text - '0');
+                text++;
+            }
+
+            Wide fraction = 0;
+            Wide scale = 1;
+            if (*text == '.') {
+                text++;
+                // Six digits keep fraction * ONE inside the Wide type
+                for (uint8_t digits = 0; *text >= '0' && *text <= '9'; text++, digits++) {
+                    if (digits < 6) {
+                        fraction = fraction * 10 + (*text - '0');
+                        scale *= 10;
+                    }
+                }
+            }
+
+            Storage raw = integer * ONE + Storage((fraction * ONE + scale / 2) / scale);
+            return fromRaw(negative ? -raw : raw);
+        }
+
+        Storage raw() const { return value; }
+
+        operator float() const { return float(value) / ONE; }
+
+        Fixed operator-() const { return fromRaw(-value); }
+        Fixed operator+(const Fixed& other) const { return fromRaw(value + other.value); }
+        Fixed operator-(const Fixed& other) const { return fromRaw(value - other.value); }
+        Fixed operator*(const Fixed& other) const { return fromRaw(Storage((Wide(value) * other.value) >> FractionBits)); }
+        Fixed operator/(const Fixed& other) const { return fromRaw(Storage((Wide(value) << FractionBits) / other.value)); }
+
+        Fixed& operator+=(const Fixed& other) { value += other.value; return *this; }
+        Fixed& operator-=(const Fixed& other) { value -= other.value; return *this; }
+
+        bool operator==(const Fixed& other) const { return value == other.value; }
+        bool operator!=(const Fixed& other) const { return value != other.value; }
+        bool operator<(const Fixed& other) const { return value < other.value; }
+        bool operator<=(const Fixed& other) const { return value <= other.value; }
+        bool operator>(const Fixed& other) const { return value > other.value; }
+        bool operator>=(const Fixed& other) const { return value >= other.value; }
+
+    private:
+        Storage value;
+};
+
+/**
+ * @brief Checks if an offset is shorter than a radius, without a square root.
+ * @param dx The x component of the offset.
+ * @param dy The y component of the offset.
+ * @param radius The radius to compare with.
+ * @return True if the offset is strictly inside the radius, false otherwise.
+ */
+inline bool isWithinDistance(float dx, float dy, float radius) {
+    return dx * dx + dy * dy < radius * radius;
+}
+
+/**
+ * @brief Checks if a fixed-point offset is shorter than a radius, without a square root.
+ *
+ * Offsets whose components do not fit in 16 bits are farther than any
+ * radius that does, so the squares are computed with 16 by 16 bit
+ * products, which the AVR does in hardware.
+ *
+ * @param dx The x component of the offset.
+ * @param dy The y component of the offset.
+ * @param radius The radius to compare with. Its raw value must fit in 16 bits.
+ * @return True if the offset is strictly inside the radius, false otherwise.
+ */
+template <typename Storage, typename Wide, uint8_t FractionBits>
+bool isWithinDistance(Fixed<Storage, Wide, FractionBits> dx, Fixed<Storage, Wide, FractionBits> dy, Fixed<Storage, Wide, FractionBits> radius) {
+    Storage x = dx.raw();
+    Storage y = dy.raw();
+    if (x > INT16_MAX || x < -INT16_MAX || y > INT16_MAX || y < -INT16_MAX) {
+        return false;
+    }
+
+    int16_t r = radius.raw();
+    uint32_t squared = uint32_t(int32_t(int16_t(x)) * int16_t(x)) + uint32_t(int32_t(int16_t(y)) * int16_t(y));
+    return squared < uint32_t(int32_t(r) * r);
+}
+
+#endif // FIXED_POINT_H
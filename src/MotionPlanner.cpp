@@ -0,0 +1,162 @@
+/**
+ * @file MotionPlanner.cpp
+ * @brief Look-ahead speed planning over the queued drawing points.
+ *
+ * Speeds follow the junction deviation model of CNC firmware: the speed at
+ * a corner is the one at which a circle tangent to both segments, cutting
+ * the corner by the junction deviation, can be followed at the maximum
+ * acceleration. A backward pass over the queue then makes sure the robot
+ * can always brake in time for the slower corners ahead.
+ */
+
+#include "MotionPlanner.h"
+
+/**
+ * @namespace RobusDraw
+ * @brief Namespace encapsulating functionality for controlling a drawing robot.
+ */
+namespace RobusDraw {
+    namespace {
+        float length(const DrawingPoint& from, const DrawingPoint& to) {
+            float dx = to.x - from.x;
+            float dy = to.y - from.y;
+            return sqrtf(dx * dx + dy * dy);
+        }
+
+        /**
+         * @brief Tells whether the robot has to stop on a point before going to the next one.
+         *
+         * Leaving a boundary point moves the pencil up or down, and loading a
+         * point of another color turns the color servo; both wait for the
+         * servos with the robot stopped.
+         */
+        bool stopsAt(const DrawingPoint& point, const DrawingPoint& next) {
+            return point.isBoundary || pencilColorChangeTime(point.color, next.color) > 0;
+        }
+    }
+
+    /**
+     * @brief Computes the fastest speed at which the robot can go through a corner.
+     *
+     * Besides the junction deviation limit, the robot must be able to turn
+     * by the corner angle while driving the shorter of the two segments,
+     * since it steers toward one point at a time. Points closer than the
+     * precision are reached as soon as they are loaded, so the robot always
+     * has at least that distance to turn.
+     *
+     * @param previous The point before the corner.
+     * @param corner The corner point.
+     * @param next The point after the corner.
+     * @param precision The distance at which a point counts as reached.
+     * @param limits The motion limits of the robot.
+     * @return The corner speed, capped by the maximum velocity.
+     */
+    float junctionSpeed(const DrawingPoint& previous, const DrawingPoint& corner, const DrawingPoint& next, float precision, const MotionLimits& limits) {
+        float inLength = length(previous, corner);
+        float outLength = length(corner, next);
+        if (inLength <= 0 || outLength <= 0) {
+            return limits.maxVelocity;
+        }
+
+        float inX = corner.x - previous.x;
+        float inY = corner.y - previous.y;
+        float outX = next.x - corner.x;
+        float outY = next.y - corner.y;
+
+        // Cosine of the angle between the reversed incoming direction and the outgoing one
+        float cosTheta = -(inX * outX + inY * outY) / (inLength * outLength);
+        if (cosTheta > 0.999) {
+            return limits.minVelocity;
+        }
+        if (cosTheta < -0.999) {
+            return limits.maxVelocity;
+        }
+
+        float sinHalfTheta = sqrtf(0.5 * (1 - cosTheta));
+        float speed = sqrtf(limits.maxAcceleration * limits.junctionDeviation * sinHalfTheta / (1 - sinHalfTheta));
+
+        float turnLength = inLength < outLength ? inLength : outLength;
+        if (turnLength < precision) {
+            turnLength = precision;
+        }
+        float turning = limits.maxAngularVelocity * turnLength / (PI - acosf(cosTheta));
+        if (turning < speed) {
+            speed = turning;
+        }
+
+        if (speed < limits.minVelocity) {
+            return limits.minVelocity;
+        }
+        return speed < limits.maxVelocity ? speed : limits.maxVelocity;
+    }
+
+    /**
+     * @brief Plans the speed at which the robot should reach its target.
+     *
+     * Walks the queued points backward from the farthest one, which is
+     * assumed to be a stop since nothing is known past it, and limits every
+     * junction by its corner speed and by the speed the robot can brake from
+     * before the next junction.
+     *
+     * @param previous The point the robot is leaving.
+     * @param target The point the robot is heading to.
+     * @param queue The points after the target.
+     * @param precision The distance at which a point counts as reached.
+     * @param limits The motion limits of the robot.
+     * @return The speed at the target.
+     */
+    float planExitSpeed(const DrawingPoint& previous, const DrawingPoint& target, const PointQueue& queue, float precision, const MotionLimits& limits) {
+        uint8_t count = queue.size() < DRAWING_PLANNER_LOOKAHEAD ? queue.size() : DRAWING_PLANNER_LOOKAHEAD;
+        if (count == 0) {
+            return 0;
+        }
+
+        float speed = 0;
+        for (int i = count - 2; i >= -1; i--) {
+            const DrawingPoint& corner = i >= 0 ? queue.peek(i) : target;
+            const DrawingPoint& before = i >= 1 ? queue.peek(i - 1) : (i == 0 ? target : previous);
+            const DrawingPoint& next = queue.peek(i + 1);
+
+            float braking = sqrtf(speed * speed + 2 * limits.maxAcceleration * length(corner, next));
+            speed = junctionSpeed(before, corner, next, precision, limits);
+            if (braking < speed) {
+                speed = braking;
+            }
+            if (stopsAt(corner, next)) {
+                speed = 0;
+            }
+        }
+        return speed;
+    }
+
+    /**
+     * @brief Computes the speed to command on the way to the target.
+     *
+     * The speed ramps up at the maximum acceleration from the current one
+     * and down so that the planned exit speed is reached on the target.
+     * The braking limit is compared on squared speeds, so the square root
+     * is only taken on the updates where the robot brakes.
+     *
+     * @param currentSpeed The speed commanded at the previous update.
+     * @param exitSpeed The planned speed at the target.
+     * @param remaining The distance left to the target.
+     * @param dt The time since the previous update, in seconds.
+     * @param limits The motion limits of the robot.
+     * @return The speed to command.
+     */
+    float profileSpeed(float currentSpeed, float exitSpeed, float remaining, float dt, const MotionLimits& limits) {
+        float speed = currentSpeed + limits.maxAcceleration * dt;
+        if (speed > limits.maxVelocity) {
+            speed = limits.maxVelocity;
+        }
+
+        float braking = exitSpeed * exitSpeed + 2 * limits.maxAcceleration * remaining;
+        if (speed * speed > braking) {
+            speed = sqrtf(braking);
+        }
+        if (speed < limits.minVelocity) {
+            speed = limits.minVelocity;
+        }
+        return speed;
+    }
+}
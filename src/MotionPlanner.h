@@ -0,0 +1,49 @@
+#ifndef MOTION_PLANNER_H
+#define MOTION_PLANNER_H
+
+#include <Arduino.h>
+#include <DrawingFormat.h>
+#include <PointQueue.h>
+
+#ifndef DRAWING_MAX_VELOCITY
+#define DRAWING_MAX_VELOCITY 12
+#endif
+
+#ifndef DRAWING_MAX_ACCELERATION
+#define DRAWING_MAX_ACCELERATION 20
+#endif
+
+#ifndef DRAWING_MAX_ANGULAR_VELOCITY
+#define DRAWING_MAX_ANGULAR_VELOCITY 3
+#endif
+
+#ifndef DRAWING_MIN_VELOCITY
+#define DRAWING_MIN_VELOCITY 0.5
+#endif
+
+#ifndef DRAWING_JUNCTION_DEVIATION
+#define DRAWING_JUNCTION_DEVIATION 0.05
+#endif
+
+#ifndef DRAWING_PLANNER_LOOKAHEAD
+#define DRAWING_PLANNER_LOOKAHEAD DRAWING_PREFETCH_CAPACITY
+#endif
+
+namespace RobusDraw {
+
+    struct MotionLimits {
+        float maxVelocity = DRAWING_MAX_VELOCITY;
+        float maxAcceleration = DRAWING_MAX_ACCELERATION;
+        float maxAngularVelocity = DRAWING_MAX_ANGULAR_VELOCITY; /**< Turn rate the robot can hold while following, in radians per second. */
+        float minVelocity = DRAWING_MIN_VELOCITY;
+        float junctionDeviation = DRAWING_JUNCTION_DEVIATION; /**< Distance the path may cut a corner by, sets the corner speeds. */
+    };
+
+    float junctionSpeed(const DrawingPoint& previous, const DrawingPoint& corner, const DrawingPoint& next, float precision, const MotionLimits& limits);
+
+    float planExitSpeed(const DrawingPoint& previous, const DrawingPoint& target, const PointQueue& queue, float precision, const MotionLimits& limits);
+
+    float profileSpeed(float currentSpeed, float exitSpeed, float remaining, float dt, const MotionLimits& limits);
+}
+
+#endif // MOTION_PLANNER_H
@@ -0,0 +1,75 @@
+/**
+ * @file PathSimplifier.cpp
+ * @brief Streaming removal of nearly collinear points ahead of the robot.
+ */
+
+#include "PathSimplifier.h"
+
+/**
+ * @namespace RobusDraw
+ * @brief Namespace encapsulating functionality for controlling a drawing robot.
+ */
+namespace RobusDraw {
+    /**
+     * @brief Computes the squared distance from a point to a segment.
+     * @param point The point to measure.
+     * @param start The start of the segment.
+     * @param end The end of the segment.
+     * @return The squared distance to the closest point of the segment.
+     */
+    float segmentDistanceSquared(const DrawingPoint& point, const DrawingPoint& start, const DrawingPoint& end) {
+        float dx = end.x - start.x;
+        float dy = end.y - start.y;
+        float px = point.x - start.x;
+        float py = point.y - start.y;
+
+        float lengthSquared = dx * dx + dy * dy;
+        float t = lengthSquared > 0 ? (px * dx + py * dy) / lengthSquared : 0;
+        if (t < 0) {
+            t = 0;
+        } else if (t > 1) {
+            t = 1;
+        }
+
+        float ex = px - t * dx;
+        float ey = py - t * dy;
+        return ex * ex + ey * ey;
+    }
+
+    /**
+     * @brief Counts the queued points the robot can skip by heading straight to a later one.
+     *
+     * A run of points is redundant when all of them lie within the tolerance
+     * of the segment from the anchor to the point after the run. Points
+     * that toggle the pencil or change its color are never skipped, so the
+     * drawing keeps its strokes and colors. Only the first
+     * DRAWING_SIMPLIFY_LOOKAHEAD queued points are considered, which bounds
+     * the work done per waypoint.
+     *
+     * @param anchor The point the robot has just reached.
+     * @param queue The points read ahead of the robot.
+     * @param tolerance The largest distance a skipped point may be from the new segment.
+     * @return The number of points to drop from the front of the queue.
+     */
+    uint8_t countRedundantPoints(const DrawingPoint& anchor, const PointQueue& queue, float tolerance) {
+        uint8_t limit = queue.size() < DRAWING_SIMPLIFY_LOOKAHEAD ? queue.size() : DRAWING_SIMPLIFY_LOOKAHEAD;
+        float toleranceSquared = tolerance * tolerance;
+        uint8_t redundant = 0;
+
+        for (uint8_t end = 1; end < limit; end++) {
+            const DrawingPoint& target = queue.peek(end);
+            const DrawingPoint& previous = queue.peek(end - 1);
+            if (previous.isBoundary || previous.color != target.color) {
+                break;
+            }
+
+            for (uint8_t i = 0; i < end; i++) {
+                if (segmentDistanceSquared(queue.peek(i), anchor, target) > toleranceSquared) {
+                    return redundant;
+                }
+            }
+            redundant = end;
+        }
+        return redundant;
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef PATH_SIMPLIFIER_H
+#define PATH_SIMPLIFIER_H
+
+#include <Arduino.h>
+#include <DrawingFormat.h>
+#include <PointQueue.h>
+
+#ifndef DRAWING_SIMPLIFY_FACTOR
+#define DRAWING_SIMPLIFY_FACTOR 0.25
+#endif
+
+#ifndef DRAWING_SIMPLIFY_LOOKAHEAD
+#define DRAWING_SIMPLIFY_LOOKAHEAD 8
+#endif
+
+namespace RobusDraw {
+
+    float segmentDistanceSquared(const DrawingPoint& point, const DrawingPoint& start, const DrawingPoint& end);
+
+    uint8_t countRedundantPoints(const DrawingPoint& anchor, const PointQueue& queue, float tolerance);
+}
+
+#endif // PATH_SIMPLIFIER_H
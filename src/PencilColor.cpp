@@ -1,4 +1,5 @@
-#include "pencilcolor.h"
+#include "PencilColor.h"
+#include <ServoMotion/ServoMotion.h>
 
 const char* pencilColorToString(PencilColor color) {
     switch (color) {
@@ -49,4 +50,21 @@ int pencilColorToAngle(PencilColor color) {
         default:
             return 0;
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Computes how long the color servo needs to turn from one pencil to another.
+ * @param from The color the servo is on.
+ * @param to The color to turn to. NONE leaves the servo where it is.
+ * @return The time in milliseconds of the ramp at PENCIL_COLOR_SPEED, 0 if the servo does not move.
+ */
+unsigned long pencilColorChangeTime(PencilColor from, PencilColor to) {
+    if (to == PencilColor::NONE) {
+        return 0;
+    }
+    int distance = abs(pencilColorToAngle(to) - pencilColorToAngle(from));
+    if (distance == 0) {
+        return 0;
+    }
+    return ServoMotion::travelTime(distance, PENCIL_COLOR_SPEED, PENCIL_COLOR_ACCELERATION);
+}
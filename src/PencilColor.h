@@ -3,6 +3,15 @@
 
 #include <Arduino.h>  // Include for strcmp function
 
+// Speed limits of the color servo, in degrees per second and per second squared
+#ifndef PENCIL_COLOR_SPEED
+#define PENCIL_COLOR_SPEED 400
+#endif
+
+#ifndef PENCIL_COLOR_ACCELERATION
+#define PENCIL_COLOR_ACCELERATION 4000
+#endif
+
 enum PencilColor {
     RED,
     BLUE,
@@ -17,4 +26,6 @@ PencilColor stringToPencilColor(const char* str);
 
 int pencilColorToAngle(PencilColor color);
 
+unsigned long pencilColorChangeTime(PencilColor from, PencilColor to);
+
 #endif // PENCILCOLOR_H
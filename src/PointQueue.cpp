@@ -0,0 +1,72 @@
+/**
+ * @file PointQueue.cpp
+ * @brief Fixed-capacity FIFO of drawing points read ahead of the robot.
+ */
+
+#include "PointQueue.h"
+
+/**
+ * @namespace RobusDraw
+ * @brief Namespace encapsulating functionality for controlling a drawing robot.
+ */
+namespace RobusDraw {
+    /**
+     * @brief Appends a point at the back of the queue.
+     * @param point The point to append.
+     * @return True if the point was queued, false if the queue is full.
+     */
+    bool PointQueue::push(const DrawingPoint& point) {
+        if (isFull()) {
+            return false;
+        }
+
+        uint8_t tail = head + count;
+        if (tail >= DRAWING_PREFETCH_CAPACITY) {
+            tail -= DRAWING_PREFETCH_CAPACITY;
+        }
+        points[tail] = point;
+        count++;
+
+        return true;
+    }
+
+    /**
+     * @brief Removes the point at the front of the queue.
+     * @param point Receives the removed point.
+     * @return True if a point was removed, false if the queue is empty.
+     */
+    bool PointQueue::pop(DrawingPoint& point) {
+        if (isEmpty()) {
+            return false;
+        }
+
+        point = points[head];
+        if (++head == DRAWING_PREFETCH_CAPACITY) {
+            head = 0;
+        }
+        count--;
+
+        return true;
+    }
+
+    /**
+     * @brief Looks at a queued point without removing it.
+     * @param index The position from the front of the queue, smaller than size().
+     * @return The queued point.
+     */
+    const DrawingPoint& PointQueue::peek(uint8_t index) const {
+        uint8_t position = head + index;
+        if (position >= DRAWING_PREFETCH_CAPACITY) {
+            position -= DRAWING_PREFETCH_CAPACITY;
+        }
+        return points[position];
+    }
+
+    /**
+     * @brief Drops every queued point.
+     */
+    void PointQueue::clear() {
+        head = 0;
+        count = 0;
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef POINT_QUEUE_H
+#define POINT_QUEUE_H
+
+#include <Arduino.h>
+#include <DrawingFormat.h>
+
+#ifndef DRAWING_PREFETCH_CAPACITY
+#define DRAWING_PREFETCH_CAPACITY 16
+#endif
+
+namespace RobusDraw {
+
+    class PointQueue {
+        public:
+            bool push(const DrawingPoint& point);
+            bool pop(DrawingPoint& point);
+            const DrawingPoint& peek(uint8_t index) const;
+            void clear();
+
+            uint8_t size() const { return count; }
+            bool isEmpty() const { return count == 0; }
+            bool isFull() const { return count == DRAWING_PREFETCH_CAPACITY; }
+
+        private:
+            DrawingPoint points[DRAWING_PREFETCH_CAPACITY];
+            uint8_t head = 0; /**< Index of the oldest point. */
+            uint8_t count = 0; /**< Number of queued points. */
+    };
+}
+
+#endif // POINT_QUEUE_H
@@ -0,0 +1,159 @@
+/**
+ * @file Profiler.cpp
+ * @brief Accumulates the time spent in named sections of the loop, to find what starves the controller.
+ *
+ * Everything lives in a fixed table, so recording a duration is a few
+ * comparisons and additions with no allocation. The whole file compiles
+ * to nothing without ROBUS_DRAW_PROFILING.
+ */
+
+#include "Profiler.h"
+
+#ifdef ROBUS_DRAW_PROFILING
+
+namespace Profiler {
+
+    /**
+     * @brief Records the duration of the timed scope.
+     */
+    ScopedTimer::~ScopedTimer() {
+        record(section, micros() - start);
+    }
+
+    /**
+     * @brief Adds a section to the table.
+     *
+     * PROFILE_SECTION() registers its section once, the first time it runs.
+     * Sections past PROFILER_MAX_SECTIONS share the last slot.
+     *
+     * @param name The name of the section. It must outlive the profiler, a string literal is fine.
+     * @return The index of the section.
+     */
+    uint8_t registerSection(const char* name) {
+        for (uint8_t i = 0; i < sectionCount; i++) {
+            if (strcmp(sections[i].name, name) == 0) {
+                return i;
+            }
+        }
+
+        if (sectionCount == PROFILER_MAX_SECTIONS) {
+            return PROFILER_MAX_SECTIONS - 1;
+        }
+
+        sections[sectionCount].name = name;
+        return sectionCount++;
+    }
+
+    /**
+     * @brief Adds a duration to a section.
+     * @param section The index of the section.
+     * @param duration The duration in microseconds.
+     */
+    void record(uint8_t section, unsigned long duration) {
+        SectionStats& stats = sections[section];
+
+        if (stats.count == 0 || duration < stats.minMicros) {
+            stats.minMicros = duration;
+        }
+        if (duration > stats.maxMicros) {
+            stats.maxMicros = duration;
+        }
+
+        stats.count++;
+        stats.totalMicros += duration;
+
+        stats.histogram[histogramBin(duration)]++;
+    }
+
+    /**
+     * @brief Retrieves the number of registered sections.
+     * @return The number of sections.
+     */
+    uint8_t getSectionCount() {
+        return sectionCount;
+    }
+
+    /**
+     * @brief Retrieves the durations measured for a section.
+     * @param section The index of the section.
+     * @return The statistics of the section.
+     */
+    SectionStats getSection(uint8_t section) {
+        return sections[section];
+    }
+
+    /**
+     * @brief Prints one line per section: count, min, mean and max in microseconds, then the histogram.
+     *
+     * Histogram bin i counts the durations under PROFILER_HISTOGRAM_BASE << i
+     * microseconds, the last bin counts the rest.
+     *
+     * @param output The stream to print to, usually Serial.
+     */
+    void dump(Print& output) {
+        output.println("PROFILE section count min mean max | histogram");
+
+        for (uint8_t i = 0; i < sectionCount; i++) {
+            const SectionStats& stats = sections[i];
+
+            output.print("PROFILE ");
+            output.print(stats.name);
+            output.print(' ');
+            output.print(stats.count);
+            output.print(' ');
+            output.print(stats.minMicros);
+            output.print(' ');
+            output.print(stats.count > 0 ? stats.totalMicros / stats.count : 0);
+            output.print(' ');
+            output.print(stats.maxMicros);
+            output.print(" |");
+
+            for (uint8_t bin = 0; bin < PROFILER_HISTOGRAM_BINS; bin++) {
+                output.print(' ');
+                output.print(stats.histogram[bin]);
+            }
+            output.println();
+        }
+    }
+
+    /**
+     * @brief Clears the durations of every section, keeping the sections registered.
+     */
+    void reset() {
+        for (uint8_t i = 0; i < sectionCount; i++) {
+            const char* name = sections[i].name;
+            sections[i] = {};
+            sections[i].name = name;
+        }
+    }
+
+    namespace {
+        /**
+         * @brief The registered sections.
+         */
+        SectionStats sections[PROFILER_MAX_SECTIONS];
+
+        /**
+         * @brief The number of registered sections.
+         */
+        uint8_t sectionCount = 0;
+
+        /**
+         * @brief Finds the histogram bin of a duration.
+         * @param duration The duration in microseconds.
+         * @return The index of the bin.
+         */
+        uint8_t histogramBin(unsigned long duration) {
+            unsigned long bound = PROFILER_HISTOGRAM_BASE;
+            uint8_t bin = 0;
+
+            while (duration >= bound && bin < PROFILER_HISTOGRAM_BINS - 1) {
+                bound <<= 1;
+                bin++;
+            }
+            return bin;
+        }
+    }
+}
+
+#endif // ROBUS_DRAW_PROFILING
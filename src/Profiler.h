@@ -0,0 +1,88 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+
+#ifndef PROFILER_MAX_SECTIONS
+#define PROFILER_MAX_SECTIONS 10
+#endif
+
+#ifndef PROFILER_HISTOGRAM_BINS
+#define PROFILER_HISTOGRAM_BINS 10
+#endif
+
+// Upper bound of the first histogram bin in microseconds, each next bin doubles it
+#ifndef PROFILER_HISTOGRAM_BASE
+#define PROFILER_HISTOGRAM_BASE 16
+#endif
+
+#define PROFILER_CONCAT_(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_(a, b)
+
+/**
+ * PROFILE_SECTION(name) times the rest of the enclosing scope under a
+ * section name, PROFILE_DUMP(output) prints every section and
+ * PROFILE_RESET() clears them. Without ROBUS_DRAW_PROFILING they expand to
+ * nothing and the profiler is not compiled in.
+ */
+#ifdef ROBUS_DRAW_PROFILING
+#define PROFILE_SECTION(name) \
+    static const uint8_t PROFILER_CONCAT(profilerSection, __LINE__) = Profiler::registerSection(name); \
+    Profiler::ScopedTimer PROFILER_CONCAT(profilerTimer, __LINE__)(PROFILER_CONCAT(profilerSection, __LINE__))
+#define PROFILE_DUMP(output) Profiler::dump(output)
+#define PROFILE_RESET() Profiler::reset()
+#else
+#define PROFILE_SECTION(name)
+#define PROFILE_DUMP(output)
+#define PROFILE_RESET()
+#endif
+
+#ifdef ROBUS_DRAW_PROFILING
+
+namespace Profiler {
+
+    /**
+     * @brief Durations measured for a named section.
+     */
+    struct SectionStats {
+        const char* name = nullptr;
+        unsigned long count = 0;
+        unsigned long minMicros = 0;
+        unsigned long maxMicros = 0;
+        unsigned long totalMicros = 0; /**< Wraps after about 71 minutes spent in the section. */
+        unsigned long histogram[PROFILER_HISTOGRAM_BINS] = {0};
+    };
+
+    /**
+     * @brief Records the time from its construction to its destruction.
+     */
+    class ScopedTimer {
+        public:
+            explicit ScopedTimer(uint8_t _section) : section(_section), start(micros()) {}
+            ~ScopedTimer();
+
+        private:
+            uint8_t section;
+            unsigned long start;
+    };
+
+    uint8_t registerSection(const char* name);
+    void record(uint8_t section, unsigned long duration);
+
+    uint8_t getSectionCount();
+    SectionStats getSection(uint8_t section);
+
+    void dump(Print& output);
+    void reset();
+
+    namespace {
+        extern SectionStats sections[PROFILER_MAX_SECTIONS];
+        extern uint8_t sectionCount;
+
+        uint8_t histogramBin(unsigned long duration);
+    }
+}
+
+#endif // ROBUS_DRAW_PROFILING
+
+#endif // PROFILER_H
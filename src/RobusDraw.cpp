@@ -13,39 +13,87 @@
 namespace RobusDraw {
     /**
      * @brief Initializes the drawing system by enabling the necessary servos and setting the initial pencil state.
+     *
+     * The servos jump to their first angle, since where they were is not
+     * known, and ramp from there on.
      */
     void initialize() {
         SERVO_Enable(PENCIL_DOWN_SERVO);
         SERVO_Enable(PENCIL_COLOR_SERVO);
-        setPencilDown(false);
+        SERVO_SetSpeed(PENCIL_DOWN_SERVO, PENCIL_DOWN_SPEED, PENCIL_DOWN_ACCELERATION);
+        SERVO_SetSpeed(PENCIL_COLOR_SERVO, PENCIL_COLOR_SPEED, PENCIL_COLOR_ACCELERATION);
+        SERVO_SetAngle(PENCIL_DOWN_SERVO, PENCIL_UP_ANGLE);
+        SERVO_SetAngle(PENCIL_COLOR_SERVO, pencilColorToAngle(state.color));
     }
 
     /**
      * @brief Manages the main update loop, controlling the movement of the drawing robot based on loaded drawing data.
+     *
+     * Runs updateDrawing(), updatePrefetch() and RobusPosition::update()
+     * back to back. A scheduler can run them as separate tasks instead.
      */
     void update() {
+        updateDrawing();
+        updatePrefetch();
+
+        PROFILE_SECTION("draw.position");
+        RobusPosition::update();
+    }
+
+    /**
+     * @brief Moves on through the drawing and commands the follow target, velocity and pencil.
+     *
+     * Only reads the points already in the prefetch queue, unless it runs
+     * dry, so its duration does not depend on the SD card.
+     */
+    void updateDrawing() {
+        SERVO_Update();
+
         bool inTimout = timeoutState.inTimeout();
         if (isDrawingLoaded() && isDrawingRunning() && !isDrawingFinished() && !inTimout) {
             RobusPosition::startFollowingTarget();
 
-            RobusPosition::Vector position = RobusPosition::getPosition();
+            RobusPosition::Vector position = getDrawingPosition();
             DrawingPoint point = getLoadedPoint();
 
-            if (dist(point.x, point.y, position.x, position.y) < precision && isDrawingLoaded() && isDrawingRunning() && !isDrawingFinished()) {
+            if (isWaypointReached(position) && isDrawingLoaded() && isDrawingRunning() && !isDrawingFinished()) {
+                markReached(state.pointIndex - 1);
+                DrawingPoint previous = point;
                 point = loadNextPoint();
-                RobusPosition::setTarget(point.x, point.y);
+                setDrawingTarget(point);
+                acceptance.setSegment(previous, point);
+
+                if (planning) {
+                    state.exitSpeed = planExitSpeed(previous, point, state.queue, precision, limits);
+                }
             }
-            setPencilDown(state.inLine);
+
+            if (planning) {
+                // Reuses the distance the acceptance test just computed, along the segment
+                followSpeedProfile(acceptance.getRemaining());
+            }
+            updatePencil();
         } else {
             RobusPosition::stopFollowingTarget();
             RobusMovement::stop();
+            state.speed = 0;
+            state.lastUpdateMicros = micros();
             
             if (inTimout) {
-                setPencilDown(timeoutState.pencilDown);
+                setPencilAngle(timeoutState.pencilAngle);
             }
         }
 
-        RobusPosition::update();
+    }
+
+    /**
+     * @brief Reads the next points of the drawing file ahead into the prefetch queue, within DRAWING_PREFETCH_BYTE_BUDGET bytes.
+     */
+    void updatePrefetch() {
+        if (isDrawingLoaded()) {
+            PROFILE_SECTION("draw.prefetch");
+            prefetch(DRAWING_PREFETCH_BYTE_BUDGET);
+        }
     }
 
     /**
@@ -80,14 +128,46 @@ namespace RobusDraw {
     int getDrawingSize() {
         return info.pointsCount;
     }
+
+    /**
+     * @brief Retrieves the name of the loaded drawing file on the SD card.
+     * @param name A character array of at least 13 characters receiving the 8.3 file name.
+     */
+    void getDrawingFileName(char* name) {
+        strcpy(name, state.drawingFile.name());
+    }
+
+    /**
+     * @brief Retrieves the number of points of the drawing loaded so far, the loaded point included.
+     * @return The number of loaded points.
+     */
+    int getPointIndex() {
+        return state.pointIndex;
+    }
+
+    /**
+     * @brief Checks if the segment toward the loaded point is drawn.
+     * @return True if the pencil is down on the current segment, false otherwise.
+     */
+    bool isPencilInLine() {
+        return state.inLine;
+    }
+
+    /**
+     * @brief Retrieves the color the pencil is turned to.
+     * @return The current pencil color.
+     */
+    PencilColor getPencilColor() {
+        return state.color;
+    }
     
     /**
-     * @brief Lowers or raises the pencil based on the specified state.
+     * @brief Lowers or raises the pencil based on the specified state, ramping at PENCIL_DOWN_SPEED.
      * @param enabled True to lower the pencil, false to raise it.
+     * @return The time in milliseconds until the pencil is all the way down or up.
      */
-    void setPencilDown(bool enabled) {
-        float angle = enabled ? PENCIL_DOWN_ANGLE : PENCIL_UP_ANGLE;
-        SERVO_SetAngle(PENCIL_DOWN_SERVO, angle);
+    unsigned long setPencilDown(bool enabled) {
+        return setPencilAngle(enabled ? PENCIL_DOWN_ANGLE : PENCIL_UP_ANGLE);
     }
 
     /**
@@ -99,10 +179,15 @@ namespace RobusDraw {
         int targetAngle = pencilColorToAngle(color);
         if (currentAngle != targetAngle) {
             if (color != NONE) {
-                unsigned long distance = fabs(targetAngle - currentAngle) / PENCIL_BETWEEN_ANGLE;
-                timeout(distance * PENCIL_CHANGE_TIME, false);
-                
-                SERVO_SetAngle(PENCIL_COLOR_SERVO, targetAngle);
+                // The carousel turns once the pencil is up
+                unsigned long lift = setPencilDown(false);
+                unsigned long turn = SERVO_MoveTo(PENCIL_COLOR_SERVO, targetAngle, lift);
+                pencil.carouselReady = millis() + turn;
+
+                // In the pipelined mode, the robot goes on to the next stroke meanwhile
+                if (!pipelining || (state.inLine && !state.approaching)) {
+                    timeout(turn, PENCIL_UP_ANGLE);
+                }
             }
             state.color = color;
         }
@@ -114,6 +199,7 @@ namespace RobusDraw {
      */
     void setPrecision(float _precision) {
         precision = _precision;
+        acceptance.setRadius(_precision);
     }
 
     /**
@@ -124,6 +210,217 @@ namespace RobusDraw {
         return precision;
     }
 
+    /**
+     * @brief Sets how far past a point the robot must go for it to count as reached without entering the precision.
+     * @param hysteresis The distance past the line through the point, perpendicular to the segment leading to it.
+     */
+    void setWaypointHysteresis(float hysteresis) {
+        acceptance.setHysteresis(hysteresis);
+    }
+
+    /**
+     * @brief Retrieves the number of points reached by going past them rather than within the precision.
+     * @return The number of points passed through since the drawing was loaded.
+     */
+    unsigned long getWaypointPassThroughs() {
+        return acceptance.getPassThroughs();
+    }
+
+    /**
+     * @brief Sets how far the path may stray from skipped points, as a fraction of the precision.
+     * @param factor The tolerance of the path simplifier divided by the precision, 0 to draw every point.
+     */
+    void setSimplification(float factor) {
+        simplification = factor;
+    }
+
+    /**
+     * @brief Retrieves the tolerance of the path simplifier as a fraction of the precision.
+     * @return The current simplification factor.
+     */
+    float getSimplification() {
+        return simplification;
+    }
+
+    /**
+     * @brief Retrieves the number of points skipped by the path simplifier.
+     * @return The number of skipped points since the drawing was loaded.
+     */
+    unsigned long getSimplifiedPoints() {
+        return state.simplified;
+    }
+
+    /**
+     * @brief Enables or disables the look-ahead speed planning.
+     *
+     * Turning it off puts back the follow velocity given to
+     * setFollowVelocity(), since the planner leaves its last speed behind.
+     *
+     * @param enabled True to command a speed with every target, false to follow at the set velocity.
+     */
+    void setMotionPlanning(bool enabled) {
+        if (planning && !enabled && !isnan(followVelocity)) {
+            RobusPosition::setFollowVelocity(followVelocity);
+        }
+        planning = enabled;
+    }
+
+    /**
+     * @brief Checks if the look-ahead speed planning is enabled.
+     * @return True if the follow velocity is planned, false otherwise.
+     */
+    bool isMotionPlanning() {
+        return planning;
+    }
+
+    /**
+     * @brief Sets the velocity at which the robot follows the drawing when the speed is not planned.
+     * @param velocity The follow velocity. Applied at once unless the speed planning is on.
+     */
+    void setFollowVelocity(float velocity) {
+        followVelocity = velocity;
+        if (!planning) {
+            RobusPosition::setFollowVelocity(velocity);
+        }
+    }
+
+    /**
+     * @brief Retrieves the velocity at which the robot follows the drawing when the speed is not planned.
+     * @return The follow velocity, NAN if it was never set.
+     */
+    float getFollowVelocity() {
+        return followVelocity;
+    }
+
+    /**
+     * @brief Enables or disables the pipelined pencil moves.
+     *
+     * When enabled, the carousel turns and the pencil goes up or down while
+     * the robot travels to the next stroke, with the pencil hovering at
+     * PENCIL_HOVER_ANGLE. The robot only stops for the pencil to clear the
+     * paper at the end of a stroke, and at the start of the next one for
+     * whatever is left of the carousel turn and the short drop to the paper.
+     *
+     * @param enabled True to overlap the pencil moves with the travel, false to stop the robot for every one of them.
+     */
+    void setPencilPipelining(bool enabled) {
+        pipelining = enabled;
+        pencil.lifting = false;
+    }
+
+    /**
+     * @brief Checks if the pencil moves are pipelined with the travel.
+     * @return True if the pipelined mode is enabled, false otherwise.
+     */
+    bool isPencilPipelining() {
+        return pipelining;
+    }
+
+    /**
+     * @brief Sets the speed and acceleration limits used by the speed planning.
+     * @param _limits The motion limits of the robot.
+     */
+    void setMotionLimits(const MotionLimits& _limits) {
+        limits = _limits;
+    }
+
+    /**
+     * @brief Retrieves the speed and acceleration limits used by the speed planning.
+     * @return The current motion limits.
+     */
+    MotionLimits getMotionLimits() {
+        return limits;
+    }
+
+    /**
+     * @brief Places the drawing relative to the odometry, for a robot that did not start on the drawing's origin.
+     *
+     * After a reboot the odometry starts over from wherever the robot
+     * stands. Giving the pose the robot had in the drawing at that moment
+     * keeps the drawing where it was. The origin stays until it is set
+     * again.
+     *
+     * @param x The x coordinate of the robot in the drawing.
+     * @param y The y coordinate of the robot in the drawing.
+     * @param orientation The heading of the robot in the drawing, in radians.
+     */
+    void setDrawingOrigin(float x, float y, float orientation) {
+        origin.enabled = x != 0 || y != 0 || orientation != 0;
+        origin.x = x;
+        origin.y = y;
+        origin.orientation = orientation;
+        origin.cosine = cos(orientation);
+        origin.sine = sin(orientation);
+    }
+
+    /**
+     * @brief Retrieves the position of the robot in the drawing.
+     * @return The odometry position moved into the drawing's frame.
+     */
+    RobusPosition::Vector getDrawingPosition() {
+        RobusPosition::Vector position = RobusPosition::getPosition();
+        if (!origin.enabled) {
+            return position;
+        }
+
+        return {
+            origin.x + position.x * origin.cosine - position.y * origin.sine,
+            origin.y + position.x * origin.sine + position.y * origin.cosine
+        };
+    }
+
+    /**
+     * @brief Retrieves the heading of the robot in the drawing.
+     * @return The odometry heading turned into the drawing's frame, in radians.
+     */
+    float getDrawingOrientation() {
+        return RobusPosition::getOrientation() + origin.orientation;
+    }
+
+    /**
+     * @brief Retrieves the index of the last point reached, from which the drawing can resume with resumeDrawing().
+     *
+     * Before the first point is reached, this is the point the drawing
+     * starts, or was resumed, from.
+     *
+     * @return The index of the point.
+     */
+    int getReachedIndex() {
+        return state.reachedIndex;
+    }
+
+    /**
+     * @brief Retrieves the position the robot had in the drawing when it reached the point of getReachedIndex().
+     * @return The position, in the drawing's frame.
+     */
+    RobusPosition::Vector getReachedPosition() {
+        return state.reachedPosition;
+    }
+
+    /**
+     * @brief Retrieves the heading the robot had in the drawing when it reached the point of getReachedIndex().
+     * @return The heading in radians.
+     */
+    float getReachedOrientation() {
+        return state.reachedOrientation;
+    }
+
+    /**
+     * @brief Retrieves the pencil color the robot had when it reached the point of getReachedIndex().
+     * @return The pencil color on the segment ending at that point.
+     */
+    PencilColor getReachedColor() {
+        return state.reachedColor;
+    }
+
+    /**
+     * @brief Checks if the segment by which the robot reached the point of getReachedIndex() was drawn.
+     * @return True if the pencil was in line on that segment, false otherwise.
+     */
+    bool isReachedInLine() {
+        return state.reachedInLine;
+    }
+
     /**
      * @brief Loads a drawing from the specified file path, extracting information and settings.
      * @param path The file path of the drawing to load.
@@ -135,14 +432,11 @@ namespace RobusDraw {
             return false;
         }
 
-        boolean readingInfo = false;
-        boolean infoExtracted = false;
-
-        boolean readingSettings = false;
-        boolean settingsExtracted = false;
-
         state = {};
         settings = {};
+        pencil.lifting = false;
+        acceptance.setSegment(loadedPoint, loadedPoint);
+        acceptance.resetPassThroughs();
         state.drawing = false;
         state.inLine = false;
         state.loaded = false;
@@ -154,97 +448,29 @@ namespace RobusDraw {
         if (!state.drawingFile) {
             return false;
         }
-        
-        /**
-         * @brief Initiates the drawing process if a drawing is loaded and not finished or running.
-         */
-        while (state.drawingFile.available() && (!settingsExtracted || !infoExtracted)) {
-            char line[50] = "\0";
-
-            getFileNextLine(line, 50);
-
-            // Info deserialization
-            if (strcmp(line, INFO_START_TAG) == 0) {
-                readingInfo = true;
-                infoExtracted = false;
-            }
-
-            if (readingInfo) {
-                int index = indexOf(line, '=') + 2;
-
-                char substr[50] = "\0";
-                substring(line, substr, index);
-
-                if (startsWith("name", line)) {
-                    strcpy(info.name, substr);
-                } else if (startsWith("width", line)) {
-                    info.width = atof(substr);
-                } else if (startsWith("height", line)) {
-                    info.height = atof(substr);
-                } else if (startsWith("pointsCount", line)) {
-                    info.pointsCount = atoi(substr);
-                }
-            }
-            
-            if (readingInfo && strcmp(line, INFO_END_TAG) == 0) {
-                readingInfo = false;
-                infoExtracted = true;
-            }
-            
-            // Settings deserialization
-            if (strcmp(line, SETTINGS_START_TAG) == 0) {
-                readingSettings = true;
-                settingsExtracted = false;
-            }
 
-            if (readingSettings) {
-                int index = indexOf(line, '=') + 2;
+        state.reader.attach(&state.drawingFile);
 
-                char substr[50] = "\0";
-                substring(line, substr, index);
+        uint8_t magic[DRAWING_BINARY_MAGIC_SIZE] = {0};
+        state.reader.read(magic, DRAWING_BINARY_MAGIC_SIZE);
+        state.reader.seek(0);
 
-                if (startsWith("followAngularVelocityScale", line)) {
-                    settings.followAngularVelocityScale = atof(substr);
-                } else if (startsWith("followVelocity", line)) {
-                    settings.followVelocity = atof(substr);
-                } else if (startsWith("curveTightness", line)) {
-                    settings.curveTightness = atof(substr);
-                }
-            }
-            
-            if (readingSettings && strcmp(line, SETTINGS_END_TAG) == 0) {
-                readingSettings = false;
-                settingsExtracted = true;
+        if (isBinaryMagic(magic)) {
+            state.encoding = BINARY_ENCODING;
+            if (!loadBinaryHeader()) {
+                return false;
             }
-        }
-
-        bool drawingHeaderFound = false;
-        while (state.drawingFile.available()) {
-            char line[50];
-
-            getFileNextLine(line, 50);
-
-            if (strcmp(line, DRAWING_START_TAG) == 0) {
-                drawingHeaderFound = true;
-                break;
+        } else {
+            state.encoding = TEXT_ENCODING;
+            if (!loadTextHeader()) {
+                return false;
             }
         }
 
-        if (!infoExtracted) {
-            Serial.println("ROBUS DRAW Missing drawing info");
-            return false;
-        }
-
-        if (!settingsExtracted) {
-            Serial.println("ROBUS DRAW Missing drawing settings");
-            return false;
-        }
-
-        if (!drawingHeaderFound) {
-            Serial.println("ROBUS DRAW Missing drawing points data");
-            return false;
-        }
+        state.pointsOffset = state.reader.position();
 
+        // Loading is not on the control path, so the queue is filled completely
+        prefetch(INT16_MAX);
         state.loaded = true;
 
         return true;
@@ -258,6 +484,7 @@ namespace RobusDraw {
             state.drawing = true;
             state.inLine = false;
             state.pointIndex = 0;
+            markReached(0);
             setPencilDown(state.inLine);
         }
     }
@@ -284,6 +511,83 @@ namespace RobusDraw {
         }
     }
 
+    /**
+     * @brief Resumes the drawing from a given point, moving to it with the pencil up first.
+     * @param pointIndex The index of the point to resume from.
+     * @return True if the drawing resumed, false if the point could not be reached in the file.
+     */
+    bool resumeDrawing(int pointIndex) {
+        if (!seekToPoint(pointIndex)) {
+            return false;
+        }
+
+        state.drawing = true;
+        return true;
+    }
+
+    /**
+     * @brief Makes a point of the loaded drawing the next target, without drawing the points before it.
+     *
+     * The file is positioned with the point index when there is one, so
+     * only the points after the closest indexed one are parsed. Without an
+     * index, every point from the start of the drawing is parsed again. The
+     * pencil stays up until the robot reaches the point.
+     *
+     * If the point cannot be read, the reader goes back to where the
+     * prefetch left it, so the queue and the file still agree and the
+     * drawing goes on as if nothing happened.
+     *
+     * @param pointIndex The index of the point to seek to.
+     * @return True if the point was found, false otherwise.
+     */
+    bool seekToPoint(int pointIndex) {
+        if (!isDrawingLoaded() || pointIndex < 0 || pointIndex >= info.pointsCount) {
+            return false;
+        }
+
+        // Taken first, looking up the index of a binary drawing moves its file
+        uint32_t prefetchOffset = state.reader.position();
+
+        IndexEntry entry = {state.pointsOffset, false};
+        int entryIndex = 0;
+        findIndexEntry(pointIndex, entry, entryIndex);
+
+        DrawingPoint point = {};
+        bool inLine = entry.inLine;
+        bool found = state.reader.seek(entry.offset);
+        for (int i = entryIndex; found && i <= pointIndex; i++) {
+            if (i > entryIndex && point.isBoundary) {
+                inLine = !inLine;
+            }
+            found = readNextPoint(point);
+        }
+
+        if (!found) {
+            state.reader.seek(prefetchOffset);
+            return false;
+        }
+
+        state.queue.clear();
+        state.readIndex = pointIndex + 1;
+        state.pointIndex = pointIndex + 1;
+        state.lastReadPoint = point;
+        state.inLine = inLine;
+        state.approaching = true;
+        state.speed = 0;
+        state.exitSpeed = 0;
+        loadedPoint = point;
+        markReached(pointIndex);
+        prefetch(INT16_MAX);
+
+        RobusPosition::Vector position = getDrawingPosition();
+        DrawingPoint start = {Coordinate(position.x), Coordinate(position.y), point.color, false};
+        setDrawingTarget(point);
+        acceptance.setSegment(start, point);
+        setPencilColor(point.color);
+
+        return true;
+    }
+
     /**
      * @brief Stops the current drawing, closing the drawing file.
      */
@@ -303,6 +607,8 @@ namespace RobusDraw {
         state.drawing = false;
         state.pointIndex = 0;
         state.drawingFile.close();
+        state.reader.attach(nullptr);
+        pencil.lifting = false;
     }
 
     /**
@@ -345,6 +651,22 @@ namespace RobusDraw {
         return float(state.pointIndex) / float(info.pointsCount - 1.0);
     }
 
+    /**
+     * @brief Retrieves the number of points read ahead and waiting in the prefetch queue.
+     * @return The number of queued points.
+     */
+    uint8_t getPrefetchDepth() {
+        return state.queue.size();
+    }
+
+    /**
+     * @brief Retrieves the number of times a point was needed while the prefetch queue was empty.
+     * @return The number of underruns since the drawing was loaded.
+     */
+    unsigned long getPrefetchUnderruns() {
+        return state.underruns;
+    }
+
     /**
      * @brief Retrieves the settings (angular velocity scale, velocity, curve tightness) of the loaded drawing.
      * @return The settings of the loaded drawing.
@@ -365,6 +687,14 @@ namespace RobusDraw {
          * @brief Represents the state of the timeout mechanism.
          */
         TimoutState timeoutState = {};
+        /**
+         * @brief Represents where the pencil servos were sent.
+         */
+        PencilState pencil = {};
+        /**
+         * @brief Represents whether the pencil moves overlap with the travel between strokes.
+         */
+        bool pipelining = false;
         /**
          * @brief Represents information about the loaded drawing.
          */
@@ -383,6 +713,39 @@ namespace RobusDraw {
          */
         float precision = 1;
 
+        /**
+         * @brief Represents the test deciding when the loaded point is reached.
+         */
+        WaypointAcceptance acceptance;
+
+        /**
+         * @brief Represents the tolerance of the path simplifier, as a fraction of the precision.
+         */
+        float simplification = DRAWING_SIMPLIFY_FACTOR;
+
+        /**
+         * @brief Represents whether the follow velocity is planned over the queued points.
+         *
+         * Off by default: on the sample drawing it is still slower than
+         * following at the fixed velocity.
+         */
+        bool planning = false;
+
+        /**
+         * @brief Represents the follow velocity used when the speed is not planned, NAN to leave RobusPosition's own.
+         */
+        float followVelocity = NAN;
+
+        /**
+         * @brief Represents the speed and acceleration limits of the robot.
+         */
+        MotionLimits limits = {};
+
+        /**
+         * @brief Represents the pose of the drawing's origin in the odometry frame.
+         */
+        DrawingOrigin origin = {};
+
         /**
          * @brief Retrieves the currently loaded drawing point.
          * @return The currently loaded drawing point.
@@ -400,57 +763,426 @@ namespace RobusDraw {
                 if (loadedPoint.isBoundary) {
                     state.inLine = !state.inLine;
                 }
+                state.approaching = false;
+
+                if (state.queue.isEmpty()) {
+                    state.underruns++;
+                    prefetch(0);
+                }
+
+                skipRedundantPoints();
+                state.queue.pop(loadedPoint);
+                state.pointIndex++;
+
+                setPencilColor(loadedPoint.color);
+            }
+            return loadedPoint;
+        }
+
+        /**
+         * @brief Drops the queued points that lie on the way from the loaded point to a later one.
+         *
+         * The skipped points are neither boundaries nor color changes, so the
+         * pencil state they would have set is the one of the point after them.
+         */
+        void skipRedundantPoints() {
+            float tolerance = simplification * precision;
+            if (tolerance <= 0) {
+                return;
+            }
+
+            uint8_t redundant = countRedundantPoints(loadedPoint, state.queue, tolerance);
+            for (uint8_t i = 0; i < redundant; i++) {
+                state.queue.pop(loadedPoint);
+            }
+            state.pointIndex += redundant;
+            state.simplified += redundant;
+        }
+
+        /**
+         * @brief Checks if the robot is done with the loaded point and can move on to the next one.
+         * @param position The current position of the robot.
+         * @return True if the robot is within the precision of the point or has gone past it, false otherwise.
+         */
+        bool isWaypointReached(const RobusPosition::Vector& position) {
+            return acceptance.isReached(Coordinate(position.x), Coordinate(position.y));
+        }
+
+        /**
+         * @brief Remembers where the robot stands as the pose from which the drawing can resume at a point.
+         *
+         * The pencil state is taken along with the pose, before the next
+         * point is loaded and changes it for the following segment.
+         *
+         * @param pointIndex The index of the point.
+         */
+        void markReached(int pointIndex) {
+            state.reachedIndex = pointIndex;
+            state.reachedPosition = getDrawingPosition();
+            state.reachedOrientation = getDrawingOrientation();
+            state.reachedColor = state.color;
+            state.reachedInLine = state.inLine;
+        }
+
+        /**
+         * @brief Commands the follow velocity for this update from the planned speed profile.
+         * @param remaining The distance left to the loaded point along its segment.
+         */
+        void followSpeedProfile(float remaining) {
+            unsigned long now = micros();
+            float dt = (now - state.lastUpdateMicros) / 1000000.0;
+            state.lastUpdateMicros = now;
+
+            state.speed = profileSpeed(state.speed, state.exitSpeed, remaining, dt, limits);
+            RobusPosition::setFollowVelocity(state.speed);
+        }
+
+        /**
+         * @brief Sends the robot toward a point of the drawing.
+         * @param point The point, in the drawing's frame.
+         */
+        void setDrawingTarget(const DrawingPoint& point) {
+            if (!origin.enabled) {
+                RobusPosition::setTarget(point.x, point.y);
+                return;
+            }
+
+            float dx = float(point.x) - origin.x;
+            float dy = float(point.y) - origin.y;
+            RobusPosition::setTarget(dx * origin.cosine + dy * origin.sine, dy * origin.cosine - dx * origin.sine);
+        }
+
+        /**
+         * @brief Reads the info and settings blocks of a text drawing, leaving the file at its first point.
+         * @return True if the header is complete, false otherwise.
+         */
+        bool loadTextHeader() {
+            boolean readingInfo = false;
+            boolean infoExtracted = false;
+
+            boolean readingSettings = false;
+            boolean settingsExtracted = false;
+
+            while (state.reader.available() && (!settingsExtracted || !infoExtracted)) {
+                char line[50] = "\0";
+
+                getFileNextLine(line, 50);
+
+                // Info deserialization
+                if (strcmp(line, INFO_START_TAG) == 0) {
+                    readingInfo = true;
+                    infoExtracted = false;
+                }
 
-                char line[100] = "\0";
-                getFileNextLine(line, 100);
+                if (readingInfo) {
+                    int index = indexOf(line, '=') + 2;
+
+                    char substr[50] = "\0";
+                    substring(line, substr, index);
+
+                    if (startsWith("name", line)) {
+                        strcpy(info.name, substr);
+                    } else if (startsWith("width", line)) {
+                        info.width = atof(substr);
+                    } else if (startsWith("height", line)) {
+                        info.height = atof(substr);
+                    } else if (startsWith("pointsCount", line)) {
+                        info.pointsCount = atoi(substr);
+                    }
+                }
+            
+                if (readingInfo && strcmp(line, INFO_END_TAG) == 0) {
+                    readingInfo = false;
+                    infoExtracted = true;
+                }
+            
+                // Settings deserialization
+                if (strcmp(line, SETTINGS_START_TAG) == 0) {
+                    readingSettings = true;
+                    settingsExtracted = false;
+                }
 
-                char* tokens[8];
-                int tokenCount;
+                if (readingSettings) {
+                    int index = indexOf(line, '=') + 2;
 
-                split(line, " ", tokens, &tokenCount);
+                    char substr[50] = "\0";
+                    substring(line, substr, index);
 
-                if (tokenCount >= 4) {
-                    loadedPoint.x = atof(tokens[0]);
-                    loadedPoint.y = atof(tokens[1]);
+                    if (startsWith("followAngularVelocityScale", line)) {
+                        settings.followAngularVelocityScale = atof(substr);
+                    } else if (startsWith("followVelocity", line)) {
+                        settings.followVelocity = atof(substr);
+                    } else if (startsWith("curveTightness", line)) {
+                        settings.curveTightness = atof(substr);
+                    }
+                }
+            
+                if (readingSettings && strcmp(line, SETTINGS_END_TAG) == 0) {
+                    readingSettings = false;
+                    settingsExtracted = true;
+                }
+            }
+
+            bool drawingHeaderFound = false;
+            while (state.reader.available()) {
+                char line[50];
 
-                    loadedPoint.color = stringToPencilColor(tokens[2]);
-                    loadedPoint.isBoundary = strcmp(tokens[3], "true") == 0 ? true : false;
+                getFileNextLine(line, 50);
+
+                if (strcmp(line, DRAWING_START_TAG) == 0) {
+                    drawingHeaderFound = true;
+                    break;
+                }
+            }
+
+            if (!infoExtracted) {
+                Serial.println("ROBUS DRAW Missing drawing info");
+                return false;
+            }
+
+            if (!settingsExtracted) {
+                Serial.println("ROBUS DRAW Missing drawing settings");
+                return false;
+            }
+
+            if (!drawingHeaderFound) {
+                Serial.println("ROBUS DRAW Missing drawing points data");
+                return false;
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief Reads the header of a binary drawing, leaving the file at its first point record.
+         * @return True if the header is valid, false otherwise.
+         */
+        bool loadBinaryHeader() {
+            uint8_t header[DRAWING_BINARY_HEADER_SIZE];
+
+            if (state.reader.read(header, DRAWING_BINARY_HEADER_SIZE) != DRAWING_BINARY_HEADER_SIZE
+                || !decodeBinaryHeader(header, info, settings, state.layout)) {
+                Serial.println("ROBUS DRAW Invalid binary drawing header");
+                return false;
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief Parses the next line of a text drawing.
+         * @param point Receives the parsed point. Left untouched if the line is malformed.
+         * @return True if a point was read, false otherwise.
+         */
+        bool readTextPoint(DrawingPoint& point) {
+            char line[100] = "\0";
+            getFileNextLine(line, 100);
+
+            char* tokens[8];
+            int tokenCount;
+
+            split(line, " ", tokens, &tokenCount);
+
+            if (tokenCount < 4) {
+                Serial.println("DEBUG DRAW : too many elements in drawing points");
+                return false;
+            }
+
+            point.x = parseCoordinate(tokens[0]);
+            point.y = parseCoordinate(tokens[1]);
+
+            point.color = stringToPencilColor(tokens[2]);
+            point.isBoundary = strcmp(tokens[3], "true") == 0 ? true : false;
+
+            return true;
+        }
+
+        /**
+         * @brief Reads the next record of a binary drawing with a single block read.
+         * @param point Receives the decoded point. Left untouched if the record is truncated.
+         * @return True if a point was read, false otherwise.
+         */
+        bool readBinaryPoint(DrawingPoint& point) {
+            uint8_t record[DRAWING_BINARY_RECORD_SIZE];
+
+            if (state.reader.read(record, DRAWING_BINARY_RECORD_SIZE) != DRAWING_BINARY_RECORD_SIZE) {
+                Serial.println("DEBUG DRAW : truncated binary drawing point");
+                return false;
+            }
+
+            decodeBinaryPoint(record, state.layout, point);
+            return true;
+        }
+
+        /**
+         * @brief Parses the next point of the drawing file, whatever its encoding.
+         * @param point Receives the point. Left untouched if the point is malformed.
+         * @return True if a point was read, false otherwise.
+         */
+        bool readNextPoint(DrawingPoint& point) {
+            if (state.encoding == BINARY_ENCODING) {
+                return readBinaryPoint(point);
+            }
+            return readTextPoint(point);
+        }
+
+        /**
+         * @brief Reads points ahead into the prefetch queue.
+         *
+         * Parsing stops once the queue is full, the drawing is fully read or
+         * byteBudget bytes were consumed from the file, so the cost of a call
+         * stays bounded. At least one point is read if there is room for it.
+         * A malformed point repeats the previous one, as the robot would
+         * otherwise keep its current target.
+         *
+         * @param byteBudget The number of bytes after which parsing stops.
+         */
+        void prefetch(int byteBudget) {
+            uint32_t start = state.reader.position();
+
+            while (!state.queue.isFull() && state.readIndex < info.pointsCount) {
+                readNextPoint(state.lastReadPoint);
+                state.queue.push(state.lastReadPoint);
+                state.readIndex++;
+
+                if (state.reader.position() - start >= (uint32_t) byteBudget) {
+                    break;
+                }
+            }
+        }
+
+        /**
+         * @brief Finds the indexed point closest before a point of the loaded drawing.
+         *
+         * The index of a binary drawing follows its point records. A text
+         * drawing has its index in a file next to it, see indexPathFor().
+         *
+         * @param pointIndex The index of the point to look up.
+         * @param entry Receives the indexed point. Left untouched if there is no usable index.
+         * @param entryIndex Receives the index of the indexed point.
+         * @return True if an index entry was found, false otherwise.
+         */
+        bool findIndexEntry(int pointIndex, IndexEntry& entry, int& entryIndex) {
+            if (state.encoding == BINARY_ENCODING) {
+                uint32_t start = state.pointsOffset + uint32_t(info.pointsCount) * DRAWING_BINARY_RECORD_SIZE;
+                return readIndexEntry(state.drawingFile, start, start, pointIndex, entry, entryIndex);
+            }
+
+            char indexPath[16];
+            indexPathFor(state.drawingFile.name(), indexPath, sizeof(indexPath));
+            if (!SD.exists(indexPath)) {
+                return false;
+            }
+
+            File indexFile = SD.open(indexPath);
+            bool found = indexFile && readIndexEntry(indexFile, 0, state.drawingFile.size(), pointIndex, entry, entryIndex);
+            indexFile.close();
+            return found;
+        }
+
+        /**
+         * @brief Reads the entry of a point index that comes closest before a point.
+         * @param file The file holding the index.
+         * @param start The position of the index in the file.
+         * @param dataSize The size of the drawing data the index must describe.
+         * @param pointIndex The index of the point to look up.
+         * @param entry Receives the indexed point. Left untouched if the index does not match the drawing.
+         * @param entryIndex Receives the index of the indexed point.
+         * @return True if an index entry was read, false otherwise.
+         */
+        bool readIndexEntry(File& file, uint32_t start, uint32_t dataSize, int pointIndex, IndexEntry& entry, int& entryIndex) {
+            uint8_t buffer[DRAWING_INDEX_HEADER_SIZE];
+            IndexHeader header;
+
+            if (!file.seek(start) || file.read(buffer, DRAWING_INDEX_HEADER_SIZE) != DRAWING_INDEX_HEADER_SIZE
+                || !decodeIndexHeader(buffer, header) || header.pointsCount != info.pointsCount || header.dataSize != dataSize) {
+                return false;
+            }
+
+            uint16_t slot = pointIndex / header.interval;
+            uint8_t record[DRAWING_INDEX_ENTRY_SIZE];
+            if (!file.seek(start + DRAWING_INDEX_HEADER_SIZE + uint32_t(slot) * DRAWING_INDEX_ENTRY_SIZE)
+                || file.read(record, DRAWING_INDEX_ENTRY_SIZE) != DRAWING_INDEX_ENTRY_SIZE) {
+                return false;
+            }
+
+            decodeIndexEntry(record, entry);
+            entryIndex = int32_t(slot) * header.interval;
+            return true;
+        }
+
+        /**
+         * @brief Sends the pencil servo to an angle, ramping at PENCIL_DOWN_SPEED.
+         * @param angle The angle in degrees.
+         * @return The time in milliseconds until the servo is at the angle.
+         */
+        unsigned long setPencilAngle(float angle) {
+            // Only the pipelined mode waits for the pencil to clear the paper, and clears the flag
+            if (pipelining && pencil.angle == PENCIL_DOWN_ANGLE && angle != PENCIL_DOWN_ANGLE) {
+                pencil.lifting = true;
+            }
+            pencil.angle = angle;
+            return SERVO_MoveTo(PENCIL_DOWN_SERVO, angle);
+        }
+
+        /**
+         * @brief Moves the pencil for the segment toward the loaded point, stopping the robot for as long as needed.
+         *
+         * Outside of the pipelined mode, the robot waits for every pencil move
+         * to end. In the pipelined mode, the pencil hovers between strokes,
+         * or stays up while the carousel turns, and the robot only waits for
+         * the pencil to leave the paper, and to be down on it again.
+         */
+        void updatePencil() {
+            if (timeoutState.inTimeout()) {
+                return;
+            }
+
+            bool pencilDown = state.inLine && !state.approaching;
+            if (!pipelining) {
+                float angle = pencilDown ? PENCIL_DOWN_ANGLE : PENCIL_UP_ANGLE;
+                timeout(setPencilAngle(angle), angle);
+                return;
+            }
+
+            long carousel = long(pencil.carouselReady - millis());
+            if (pencilDown) {
+                if (carousel > 0) {
+                    timeout(carousel, PENCIL_UP_ANGLE);
                 } else {
-                    Serial.println("DEBUG DRAW : too many elements in drawing points");
+                    timeout(setPencilAngle(PENCIL_DOWN_ANGLE), PENCIL_DOWN_ANGLE);
                 }
-                state.pointIndex++;
+                return;
+            }
 
-                setPencilColor(loadedPoint.color);
+            float angle = carousel > 0 ? PENCIL_UP_ANGLE : PENCIL_HOVER_ANGLE;
+            unsigned long time = setPencilAngle(angle);
+            if (pencil.lifting) {
+                // The pencil is off the paper once past the hover angle, which takes
+                // at most as long as a move that stops there
+                unsigned long clear = ServoMotion::travelTime(abs(PENCIL_HOVER_ANGLE - PENCIL_DOWN_ANGLE), PENCIL_DOWN_SPEED, PENCIL_DOWN_ACCELERATION);
+                pencil.lifting = false;
+                timeout(time < clear ? time : clear, angle);
             }
-            return loadedPoint;
         }
 
         /**
          * @brief Sets a timeout for a specified duration with an optional pencil state.
          * @param time The duration of the timeout in milliseconds.
-         * @param isPencilDown The state of the pencil during the timeout.
+         * @param pencilAngle The angle the pencil servo goes to during the timeout.
          */
-        void timeout(unsigned long time, bool isPencilDown) {
+        void timeout(unsigned long time, float pencilAngle) {
             timeoutState.time = millis() + time;
-            timeoutState.pencilDown = isPencilDown;
+            timeoutState.pencilAngle = pencilAngle;
         }
 
         /**
-         * @brief Reads the next line from the drawing file.
+         * @brief Reads the next line from the drawing file through the block reader.
          * @param line A character array to store the read line.
          * @param size The size of the character array.
          */
         void getFileNextLine(char* line, int size) {
-            line[size - 1] = '\0';
-
-            for (int i = 0; i < size; i++) {
-                char c = state.drawingFile.read();
-                if (c == '\n' || state.drawingFile.available() == 0) {
-                    line[i] = '\0';
-                    return;
-                }
-                line[i] = c;
-            }
+            state.reader.readLine(line, size);
         }
 
         /**
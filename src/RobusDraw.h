@@ -4,42 +4,45 @@
 #include <LibRobus.h>
 #include <RobusPosition.h>
 #include <PencilColor.h>
+#include <ServoMotion/ServoMotion.h>
 #include <SPI.h>
 #include <SD.h>
 #include <SDState.h>
+#include <DrawingFormat.h>
+#include <BufferedFileReader.h>
+#include <PointQueue.h>
+#include <PathSimplifier.h>
+#include <MotionPlanner.h>
+#include <WaypointAcceptance.h>
+#include <Profiler.h>
 
 #define PENCIL_DOWN_SERVO SERVO_2
 #define PENCIL_UP_ANGLE 145
 #define PENCIL_DOWN_ANGLE 130 //130
 
-#define PENCIL_COLOR_SERVO SERVO_1
-#define PENCIL_BETWEEN_ANGLE 40
+// Speed limits of the pencil servo, low enough for the pencil to touch the paper without bouncing
+#ifndef PENCIL_DOWN_SPEED
+#define PENCIL_DOWN_SPEED 90
+#endif
 
-#define PENCIL_CHANGE_TIME 200
+#ifndef PENCIL_DOWN_ACCELERATION
+#define PENCIL_DOWN_ACCELERATION 900
+#endif
 
+// Angle at which the pencil is just off the paper, where it travels between strokes in the pipelined mode
+#ifndef PENCIL_HOVER_ANGLE
+#define PENCIL_HOVER_ANGLE 135
+#endif
 
-namespace RobusDraw {
-    
-    struct DrawingInfo {
-        char name[20];
-        float width;
-        float height;
-        int pointsCount;
-    };
+#define PENCIL_COLOR_SERVO SERVO_1
 
-    struct DrawingSettings {
-        float followAngularVelocityScale = NAN; /**< Scale factor for angular velocity when following a target. */
-        float followVelocity = NAN; /**< Velocity at which the robot follows a target. */
-        float curveTightness = NAN; /**< Tightness of the curve when following a target. */
-    };
+#ifndef DRAWING_PREFETCH_BYTE_BUDGET
+#define DRAWING_PREFETCH_BYTE_BUDGET 32
+#endif
 
-    struct DrawingPoint {
-        float x;
-        float y;
-        PencilColor color;
-        bool isBoundary;
-    };
 
+namespace RobusDraw {
+    
     struct DrawingState {
         bool loaded = false;
         int pointIndex = 0;
@@ -48,12 +51,56 @@ namespace RobusDraw {
         bool drawing = false;
         PencilColor color = BLACK;
 
+        DrawingEncoding encoding = TEXT_ENCODING;
+        BinaryLayout layout = {};
+
         File drawingFile;
+        BufferedFileReader reader;
+
+        PointQueue queue;
+        uint32_t pointsOffset = 0; /**< Position of the first point in the file. */
+        int readIndex = 0; /**< Number of points parsed from the file, queued or consumed. */
+        DrawingPoint lastReadPoint = {};
+        unsigned long underruns = 0;
+        unsigned long simplified = 0; /**< Number of points skipped by the path simplifier. */
+
+        float speed = 0; /**< Follow velocity commanded at the previous update. */
+        float exitSpeed = 0; /**< Planned speed on the loaded point. */
+        unsigned long lastUpdateMicros = 0;
+
+        bool approaching = false; /**< Keeps the pencil up until the point sought by seekToPoint() is reached. */
+
+        int reachedIndex = 0; /**< Index of the last point reached, or sought by seekToPoint(), from which the drawing can resume. */
+        RobusPosition::Vector reachedPosition = {}; /**< Position of the robot in the drawing when it reached that point. */
+        float reachedOrientation = 0;
+        PencilColor reachedColor = BLACK; /**< Pencil color on the segment by which the robot reached that point. */
+        bool reachedInLine = false;
+    };
+
+    /**
+     * @brief Pose of the drawing's origin in the odometry frame.
+     */
+    struct DrawingOrigin {
+        bool enabled = false;
+        float x = 0;
+        float y = 0;
+        float orientation = 0;
+        float cosine = 1;
+        float sine = 0;
+    };
+
+    /**
+     * @brief Where the pencil servos were sent, kept across drawings like the servos themselves.
+     */
+    struct PencilState {
+        float angle = PENCIL_UP_ANGLE; /**< Angle the pencil servo was last sent to. */
+        bool lifting = false; /**< The pencil left the paper angle and the robot did not wait for it to clear the paper yet. */
+        unsigned long carouselReady = 0; /**< millis() when the color servo is done turning. */
     };
 
     struct TimoutState {
         unsigned long time = 0;
-        bool pencilDown = false;
+        float pencilAngle = PENCIL_UP_ANGLE;
 
         bool inTimeout() {
             return millis() < time;
@@ -62,23 +109,55 @@ namespace RobusDraw {
 
     void initialize();
     void update();
+    void updateDrawing();
+    void updatePrefetch();
 
     void getDrawingName(char* name);
     float getDrawingWidth();
     float getDrawingHeight();
     int getDrawingSize();
+    void getDrawingFileName(char* name);
+    int getPointIndex();
+    bool isPencilInLine();
+    PencilColor getPencilColor();
 
 
-    void setPencilDown(bool enabled);
+    unsigned long setPencilDown(bool enabled);
     void setPencilColor(PencilColor color);
 
     void setPrecision(float _precision);
     float getPrecision();
+    void setWaypointHysteresis(float hysteresis);
+    unsigned long getWaypointPassThroughs();
+
+    void setSimplification(float factor);
+    float getSimplification();
+    unsigned long getSimplifiedPoints();
+
+    void setMotionPlanning(bool enabled);
+    bool isMotionPlanning();
+    void setFollowVelocity(float velocity);
+    float getFollowVelocity();
+    void setPencilPipelining(bool enabled);
+    bool isPencilPipelining();
+    void setMotionLimits(const MotionLimits& _limits);
+    MotionLimits getMotionLimits();
+
+    void setDrawingOrigin(float x, float y, float orientation);
+    RobusPosition::Vector getDrawingPosition();
+    float getDrawingOrientation();
+    int getReachedIndex();
+    RobusPosition::Vector getReachedPosition();
+    float getReachedOrientation();
+    PencilColor getReachedColor();
+    bool isReachedInLine();
 
     bool loadDrawing(char* path);
     void startDrawing();
     void restartDrawing();
     void resumeDrawing();
+    bool resumeDrawing(int pointIndex);
+    bool seekToPoint(int pointIndex);
     void pauseDrawing();
     void stopDrawing();
 
@@ -89,6 +168,9 @@ namespace RobusDraw {
 
     float getProgress();
 
+    uint8_t getPrefetchDepth();
+    unsigned long getPrefetchUnderruns();
+
     DrawingInfo getDrawingInfo();
     DrawingSettings getDrawingSettings();
 
@@ -103,15 +185,40 @@ namespace RobusDraw {
 
         extern DrawingState state;
         extern TimoutState timeoutState;
+        extern PencilState pencil;
+        extern bool pipelining;
         extern DrawingInfo info;
         extern DrawingSettings settings;
         extern DrawingPoint loadedPoint;
         extern float precision;
+        extern WaypointAcceptance acceptance;
+        extern float simplification;
+        extern bool planning;
+        extern float followVelocity;
+        extern MotionLimits limits;
+        extern DrawingOrigin origin;
 
         DrawingPoint getLoadedPoint();
         DrawingPoint loadNextPoint();
-
-        void timeout(unsigned long time, bool isPencilDown);
+        void skipRedundantPoints();
+        bool isWaypointReached(const RobusPosition::Vector& position);
+        void markReached(int pointIndex);
+        void followSpeedProfile(float remaining);
+        void setDrawingTarget(const DrawingPoint& point);
+
+        bool loadTextHeader();
+        bool loadBinaryHeader();
+        bool readTextPoint(DrawingPoint& point);
+        bool readBinaryPoint(DrawingPoint& point);
+        bool readNextPoint(DrawingPoint& point);
+        void prefetch(int byteBudget);
+        bool findIndexEntry(int pointIndex, IndexEntry& entry, int& entryIndex);
+        bool readIndexEntry(File& file, uint32_t start, uint32_t dataSize, int pointIndex, IndexEntry& entry, int& entryIndex);
+
+        unsigned long setPencilAngle(float angle);
+        void updatePencil();
+
+        void timeout(unsigned long time, float pencilAngle);
 
         void getFileNextLine(char* line, int size);
         bool startsWith(const char *start, const char *text);
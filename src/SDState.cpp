@@ -1,4 +1,5 @@
 #include "SDState.h"
+#include <LibRobus.h>
 
 /**
  * @file sd_state.h
@@ -9,9 +10,15 @@ namespace SDState {
     /**
      * @brief Register the chip select pin for the SD card.
      * @param chipSelect The pin to be used as the chip select for the SD card.
+     * @param _detectPin The card-detect switch of the socket, or SD_NO_DETECT_PIN if it is not wired.
      */
-    void registerCard(uint8_t chipSelect) {
+    void registerCard(uint8_t chipSelect, uint8_t _detectPin) {
         chipSelectPin = chipSelect;
+        detectPin = _detectPin;
+
+        if (detectPin != SD_NO_DETECT_PIN) {
+            pinMode(detectPin, INPUT_PULLUP);
+        }
     }
 
     /**
@@ -19,14 +26,46 @@ namespace SDState {
      * 
      * This function checks the current state of the SD card and compares it
      * with the previous state. If there is a change, the listener is notified.
+     * The card is only checked once per polling period, and only initialized
+     * again when it was missing or was swapped.
      */
     void refresh() {
-        SDState newState = SD.begin(chipSelectPin) ? PRESENT : NOT_PRESENT;
+        unsigned long now = millis();
+        if (state != UNKNOWN && now - lastPoll < pollPeriod) {
+            return;
+        }
+        lastPoll = now;
+
+        unsigned long start = micros();
+        SDState newState = probe();
 
         if (newState != state) {
             listener(newState);
             state = newState;
         }
+
+        stats.lastMicros = micros() - start;
+        stats.totalMicros += stats.lastMicros;
+        if (stats.lastMicros > stats.maxMicros) {
+            stats.maxMicros = stats.lastMicros;
+        }
+        stats.polls++;
+    }
+
+    /**
+     * @brief Set the time between two checks of the card.
+     * @param period The period in milliseconds. 0 checks the card on every refresh.
+     */
+    void setPollPeriod(unsigned long period) {
+        pollPeriod = period;
+    }
+
+    /**
+     * @brief Get the time spent checking the card.
+     * @return The number of polls and their duration in microseconds, the listener calls included.
+     */
+    PollStats getPollStats() {
+        return stats;
     }
 
     /**
@@ -77,6 +116,13 @@ namespace SDState {
          */
         uint8_t chipSelectPin = 0;
 
+        /**
+         * @brief The card-detect pin of the socket.
+         * 
+         * SD_NO_DETECT_PIN when the socket has no card-detect switch wired.
+         */
+        uint8_t detectPin = SD_NO_DETECT_PIN;
+
         /**
          * @brief The current state of the SD card.
          * 
@@ -91,5 +137,79 @@ namespace SDState {
          * that will be called when the state of the SD card changes.
          */
         void (*listener)(SDState);
+
+        /**
+         * @brief The time between two checks of the card, in milliseconds.
+         */
+        unsigned long pollPeriod = SD_POLL_PERIOD;
+
+        /**
+         * @brief The time of the last check of the card.
+         */
+        unsigned long lastPoll = 0;
+
+        /**
+         * @brief The time spent checking the card.
+         */
+        PollStats stats = {};
+
+        /**
+         * @brief A second handle on the card, used to read its identification register.
+         * 
+         * The SD library keeps its own handle private, so this one is
+         * initialized along with it.
+         */
+        Sd2Card probeCard;
+
+        /**
+         * @brief The identification register of the card that was initialized.
+         */
+        cid_t cardId;
+
+        /**
+         * @brief Check if the card is there without initializing it again.
+         * 
+         * With a card-detect pin, the pin alone tells if there is a card.
+         * Otherwise the identification register of the card is read, a
+         * single command that fails when the card is gone and changes when
+         * the card was swapped. The card is initialized again only when it
+         * was not present: a present card that fails the probe reads as
+         * removed, and is initialized on a later poll once the files on it
+         * were closed by the listener.
+         * 
+         * @return The state of the SD card.
+         */
+        SDState probe() {
+            if (detectPin != SD_NO_DETECT_PIN && digitalRead(detectPin) != SD_DETECT_ACTIVE) {
+                return NOT_PRESENT;
+            }
+
+            if (state == PRESENT) {
+                if (detectPin != SD_NO_DETECT_PIN) {
+                    return PRESENT;
+                }
+
+                // A swapped card reads as removed, then as present on the next poll
+                cid_t id;
+                return probeCard.readCID(&id) && memcmp(&id, &cardId, sizeof(cid_t)) == 0 ? PRESENT : NOT_PRESENT;
+            }
+
+            return initializeCard() ? PRESENT : NOT_PRESENT;
+        }
+
+        /**
+         * @brief Initialize the card and its file system.
+         * @return True if the card is ready to be used, false otherwise.
+         */
+        bool initializeCard() {
+            // Starting a card clocks the bus with its chip select HIGH, where
+            // the control interrupt cannot tell the bus is in use
+            CONTROL_LockSPI();
+            bool ready = probeCard.init(SPI_HALF_SPEED, chipSelectPin)
+                && probeCard.readCID(&cardId)
+                && SD.begin(chipSelectPin);
+            CONTROL_UnlockSPI();
+            return ready;
+        }
     }
 }
\ No newline at end of file
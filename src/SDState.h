@@ -4,6 +4,16 @@
 #include <Arduino.h>  // Include for strcmp function
 #include <SD.h>
 
+#define SD_NO_DETECT_PIN 0xFF
+
+#ifndef SD_DETECT_ACTIVE
+#define SD_DETECT_ACTIVE LOW
+#endif
+
+#ifndef SD_POLL_PERIOD
+#define SD_POLL_PERIOD 250
+#endif
+
 namespace SDState {
 
     enum SDState {
@@ -12,9 +22,21 @@ namespace SDState {
         PRESENT
     };
 
-    void registerCard(uint8_t chipSelect);
+    /**
+     * @brief Time spent polling the card.
+     */
+    struct PollStats {
+        unsigned long polls = 0;
+        unsigned long lastMicros = 0;
+        unsigned long maxMicros = 0;
+        unsigned long long totalMicros = 0;
+    };
+
+    void registerCard(uint8_t chipSelect, uint8_t detectPin = SD_NO_DETECT_PIN);
 
     void refresh();
+    void setPollPeriod(unsigned long period);
+    PollStats getPollStats();
 
     void setListener(void (*_listener)(SDState));
 
@@ -26,9 +48,20 @@ namespace SDState {
 
     namespace {
         extern uint8_t chipSelectPin;
+        extern uint8_t detectPin;
         extern SDState state;
 
+        extern unsigned long pollPeriod;
+        extern unsigned long lastPoll;
+        extern PollStats stats;
+
+        extern Sd2Card probeCard;
+        extern cid_t cardId;
+
         extern void (*listener)(SDState);
+
+        SDState probe();
+        bool initializeCard();
     }
 }
 
@@ -0,0 +1,243 @@
+/**
+ * @file Scheduler.cpp
+ * @brief Cooperative scheduler running the tasks of the robot by priority, with fixed-rate periodic tasks.
+ *
+ * Periodic tasks are released every period from their first release, not
+ * from when they last ran, so a late run does not shift the next ones.
+ * Tasks with no period run whenever nothing more urgent is due, taking
+ * turns when they share a priority.
+ *
+ * Nothing can interrupt a running task, so a task only starts if its
+ * longest run so far ends before the next release of every more urgent
+ * periodic task. A task that could never fit between two runs of a more
+ * urgent one starts anyway, which happens right after that one ran.
+ */
+
+#include "Scheduler.h"
+
+namespace Scheduler {
+
+    /**
+     * @brief Adds a task to the scheduler. Its first release is now.
+     * @param name The name of the task, for dump(). It must outlive the scheduler.
+     * @param callback The function to run.
+     * @param period The time between two runs in microseconds, or 0 to run the task whenever there is time.
+     * @param priority The priority of the task, 0 being the most urgent.
+     * @return The index of the task, or SCHEDULER_NO_TASK if there are already SCHEDULER_MAX_TASKS tasks.
+     */
+    uint8_t addTask(const char* name, void (*callback)(), unsigned long period, uint8_t priority) {
+        if (taskCount == SCHEDULER_MAX_TASKS) {
+            return SCHEDULER_NO_TASK;
+        }
+
+        Task& task = tasks[taskCount];
+        task = {};
+        task.name = name;
+        task.callback = callback;
+        task.period = period;
+        task.priority = priority;
+        task.enabled = true;
+        task.release = micros();
+
+        return taskCount++;
+    }
+
+    /**
+     * @brief Enables or disables a task. An enabled periodic task is released right away.
+     * @param task The index of the task.
+     * @param enabled True to run the task, false to skip it.
+     */
+    void setTaskEnabled(uint8_t task, bool enabled) {
+        if (task >= taskCount) {
+            return;
+        }
+
+        if (enabled && !tasks[task].enabled) {
+            tasks[task].release = micros();
+        }
+        tasks[task].enabled = enabled;
+    }
+
+    /**
+     * @brief Runs the most urgent task that is due, if any. Call it from loop().
+     * @return True if a task ran, false if the scheduler is idle.
+     */
+    bool run() {
+        unsigned long now = micros();
+        uint8_t task = pickTask(now);
+        if (task == SCHEDULER_NO_TASK) {
+            return false;
+        }
+
+        runTask(tasks[task], now);
+        nextBackground = task + 1;
+        return true;
+    }
+
+    /**
+     * @brief Retrieves the number of tasks.
+     * @return The number of tasks.
+     */
+    uint8_t getTaskCount() {
+        return taskCount;
+    }
+
+    /**
+     * @brief Retrieves a task and its timing statistics.
+     * @param task The index of the task.
+     * @return A copy of the task.
+     */
+    Task getTask(uint8_t task) {
+        return tasks[task];
+    }
+
+    /**
+     * @brief Retrieves the number of releases missed by all the tasks.
+     * @return The number of missed releases.
+     */
+    unsigned long getMisses() {
+        unsigned long misses = 0;
+        for (uint8_t i = 0; i < taskCount; i++) {
+            misses += tasks[i].misses;
+        }
+        return misses;
+    }
+
+    /**
+     * @brief Clears the timing statistics of every task.
+     */
+    void resetStats() {
+        for (uint8_t i = 0; i < taskCount; i++) {
+            tasks[i].runs = 0;
+            tasks[i].misses = 0;
+            tasks[i].maxLateness = 0;
+            tasks[i].maxDuration = 0;
+        }
+    }
+
+    /**
+     * @brief Prints one line per task: runs, missed releases, largest lateness and longest run in microseconds.
+     * @param output The stream to print to, usually Serial.
+     */
+    void dump(Print& output) {
+        output.println("TASK name period runs misses lateness duration");
+
+        for (uint8_t i = 0; i < taskCount; i++) {
+            output.print("TASK ");
+            output.print(tasks[i].name);
+            output.print(' ');
+            output.print(tasks[i].period);
+            output.print(' ');
+            output.print(tasks[i].runs);
+            output.print(' ');
+            output.print(tasks[i].misses);
+            output.print(' ');
+            output.print(tasks[i].maxLateness);
+            output.print(' ');
+            output.println(tasks[i].maxDuration);
+        }
+    }
+
+    namespace {
+        /**
+         * @brief The tasks, in the order they were added.
+         */
+        Task tasks[SCHEDULER_MAX_TASKS];
+
+        /**
+         * @brief The number of tasks.
+         */
+        uint8_t taskCount = 0;
+
+        /**
+         * @brief The task after the last one that ran, where the search for a task starts, so tasks of equal priority take turns.
+         */
+        uint8_t nextBackground = 0;
+
+        /**
+         * @brief Finds the most urgent task that is due and fits before the more urgent ones.
+         * @param now The current time in microseconds.
+         * @return The index of the task, or SCHEDULER_NO_TASK if none can run.
+         */
+        uint8_t pickTask(unsigned long now) {
+            uint8_t best = SCHEDULER_NO_TASK;
+
+            for (uint8_t offset = 0; offset < taskCount; offset++) {
+                uint8_t i = (nextBackground + offset) % taskCount;
+                const Task& task = tasks[i];
+
+                if (best != SCHEDULER_NO_TASK && task.priority >= tasks[best].priority) {
+                    continue;
+                }
+                if (isDue(task, now) && fitsBeforeUrgentTasks(task, now)) {
+                    best = i;
+                }
+            }
+
+            return best;
+        }
+
+        /**
+         * @brief Checks if a task can run now.
+         * @param task The task.
+         * @param now The current time in microseconds.
+         * @return True if the task is enabled and released, false otherwise.
+         */
+        bool isDue(const Task& task, unsigned long now) {
+            return task.enabled && (task.period == 0 || long(now - task.release) >= 0);
+        }
+
+        /**
+         * @brief Checks if a task would end before the next release of every more urgent periodic task.
+         * @param task The task.
+         * @param now The current time in microseconds.
+         * @return True if the task can start now, false if it should wait.
+         */
+        bool fitsBeforeUrgentTasks(const Task& task, unsigned long now) {
+            for (uint8_t i = 0; i < taskCount; i++) {
+                const Task& urgent = tasks[i];
+                if (!urgent.enabled || urgent.period == 0 || urgent.priority >= task.priority) {
+                    continue;
+                }
+
+                bool canEverFit = task.maxDuration + urgent.maxDuration < urgent.period;
+                if (canEverFit && long(urgent.release - now) < long(task.maxDuration)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Runs a task and updates its release and statistics.
+         * @param task The task.
+         * @param now The current time in microseconds.
+         */
+        void runTask(Task& task, unsigned long now) {
+            if (task.period > 0) {
+                unsigned long lateness = now - task.release;
+
+                // Releases that already passed entirely are skipped rather than run in a burst
+                if (lateness >= task.period) {
+                    unsigned long missed = lateness / task.period;
+                    task.misses += missed;
+                    task.release += missed * task.period;
+                    lateness -= missed * task.period;
+                }
+
+                if (lateness > task.maxLateness) {
+                    task.maxLateness = lateness;
+                }
+                task.release += task.period;
+            }
+
+            task.callback();
+
+            unsigned long duration = micros() - now;
+            if (duration > task.maxDuration) {
+                task.maxDuration = duration;
+            }
+            task.runs++;
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+
+#ifndef SCHEDULER_MAX_TASKS
+#define SCHEDULER_MAX_TASKS 8
+#endif
+
+#define SCHEDULER_NO_TASK 0xFF
+
+namespace Scheduler {
+
+    /**
+     * @brief A function called by the scheduler, with its timing statistics.
+     */
+    struct Task {
+        const char* name = nullptr;
+        void (*callback)() = nullptr;
+        unsigned long period = 0; /**< Time between two releases in microseconds, 0 for a task that runs whenever there is time. */
+        uint8_t priority = 0; /**< 0 is the most urgent. */
+        bool enabled = false;
+
+        unsigned long release = 0; /**< Time from which the task is due. */
+        unsigned long runs = 0;
+        unsigned long misses = 0; /**< Number of releases skipped because the previous one ran a whole period late. */
+        unsigned long maxLateness = 0; /**< Largest delay between a release and the start of the task, in microseconds. */
+        unsigned long maxDuration = 0; /**< Longest run of the task, in microseconds. */
+    };
+
+    uint8_t addTask(const char* name, void (*callback)(), unsigned long period, uint8_t priority);
+    void setTaskEnabled(uint8_t task, bool enabled);
+
+    bool run();
+
+    uint8_t getTaskCount();
+    Task getTask(uint8_t task);
+    unsigned long getMisses();
+    void resetStats();
+    void dump(Print& output);
+
+    namespace {
+        extern Task tasks[SCHEDULER_MAX_TASKS];
+        extern uint8_t taskCount;
+        extern uint8_t nextBackground;
+
+        uint8_t pickTask(unsigned long now);
+        bool isDue(const Task& task, unsigned long now);
+        bool fitsBeforeUrgentTasks(const Task& task, unsigned long now);
+        void runTask(Task& task, unsigned long now);
+    }
+}
+
+#endif // SCHEDULER_H
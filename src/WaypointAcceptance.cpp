@@ -0,0 +1,92 @@
+/**
+ * @file WaypointAcceptance.cpp
+ * @brief Waypoint reached test run on every update.
+ *
+ * A waypoint counts as reached when the robot is within the radius of it,
+ * compared on squared distances, or when the robot has gone past the line
+ * through the waypoint perpendicular to the segment it arrived by. The
+ * second test catches the overshoots that would otherwise make the robot
+ * turn around and wiggle back into the radius. The same dot product gives
+ * the distance left along the segment, which the speed planning reuses.
+ */
+
+#include "WaypointAcceptance.h"
+
+/**
+ * @namespace RobusDraw
+ * @brief Namespace encapsulating functionality for controlling a drawing robot.
+ */
+namespace RobusDraw {
+    /**
+     * @brief Sets the distance under which a waypoint counts as reached.
+     * @param _radius The radius around the waypoint.
+     */
+    void WaypointAcceptance::setRadius(float _radius) {
+        radius = Coordinate(_radius);
+    }
+
+    /**
+     * @brief Sets how far past a waypoint the robot must go for it to count as passed.
+     * @param _hysteresis The distance past the perpendicular line through the waypoint. Applies from the next segment.
+     */
+    void WaypointAcceptance::setHysteresis(float _hysteresis) {
+        hysteresis = _hysteresis;
+    }
+
+    /**
+     * @brief Sets the waypoint to reach and the segment the robot reaches it by.
+     *
+     * This is the only place where a square root is taken, once per waypoint.
+     *
+     * @param from The previous waypoint.
+     * @param to The waypoint to reach.
+     */
+    void WaypointAcceptance::setSegment(const DrawingPoint& from, const DrawingPoint& to) {
+        targetX = to.x;
+        targetY = to.y;
+        directionX = to.x - from.x;
+        directionY = to.y - from.y;
+
+        float dx = directionX;
+        float dy = directionY;
+        float length = sqrtf(dx * dx + dy * dy);
+        passThreshold = Coordinate(hysteresis * length);
+        inverseLength = length > 0 ? 1 / length : 0;
+        along = -(directionX * directionX + directionY * directionY);
+    }
+
+    /**
+     * @brief Checks if the robot has reached or gone past the waypoint.
+     * @param x The x coordinate of the robot.
+     * @param y The y coordinate of the robot.
+     * @return True if the robot can move on to the next waypoint, false otherwise.
+     */
+    bool WaypointAcceptance::isReached(Coordinate x, Coordinate y) {
+        Coordinate offsetX = x - targetX;
+        Coordinate offsetY = y - targetY;
+        along = offsetX * directionX + offsetY * directionY;
+
+        if (isWithinDistance(offsetX, offsetY, radius)) {
+            return true;
+        }
+
+        // A zero length segment has no direction to pass through
+        if (along > passThreshold && (directionX != Coordinate(0) || directionY != Coordinate(0))) {
+            passThroughs++;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Retrieves the distance left to the waypoint along the segment.
+     *
+     * Computed from the dot product of the last test only when asked for,
+     * so the test itself stays free of float work when nothing plans speeds.
+     *
+     * @return The distance left as of the last test, the segment length before any test.
+     */
+    float WaypointAcceptance::getRemaining() const {
+        return along < Coordinate(0) ? -float(along) * inverseLength : 0;
+    }
+}
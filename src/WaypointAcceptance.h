@@ -0,0 +1,44 @@
+#ifndef WAYPOINT_ACCEPTANCE_H
+#define WAYPOINT_ACCEPTANCE_H
+
+#include <Arduino.h>
+#include <DrawingFormat.h>
+
+#ifndef DRAWING_WAYPOINT_HYSTERESIS
+#define DRAWING_WAYPOINT_HYSTERESIS 0.05
+#endif
+
+namespace RobusDraw {
+
+    /**
+     * @brief Decides when the robot has reached the waypoint it is heading to.
+     */
+    class WaypointAcceptance {
+        public:
+            void setRadius(float radius);
+            void setHysteresis(float hysteresis);
+            void setSegment(const DrawingPoint& from, const DrawingPoint& to);
+
+            bool isReached(Coordinate x, Coordinate y);
+            float getRemaining() const;
+
+            unsigned long getPassThroughs() const { return passThroughs; }
+            void resetPassThroughs() { passThroughs = 0; }
+
+        private:
+            Coordinate targetX = Coordinate(0);
+            Coordinate targetY = Coordinate(0);
+            Coordinate directionX = Coordinate(0); /**< Segment from the previous waypoint to the target. */
+            Coordinate directionY = Coordinate(0);
+
+            Coordinate radius = Coordinate(1);
+            float hysteresis = DRAWING_WAYPOINT_HYSTERESIS;
+            Coordinate passThreshold = Coordinate(0); /**< Hysteresis times the segment length, compared with a dot product. */
+            float inverseLength = 0; /**< One over the segment length, turns the dot product into a distance. */
+            Coordinate along = Coordinate(0); /**< Dot product of the offset to the waypoint and the segment, as of the last test. */
+
+            unsigned long passThroughs = 0;
+    };
+}
+
+#endif // WAYPOINT_ACCEPTANCE_H
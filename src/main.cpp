@@ -1,6 +1,9 @@
 #include <Arduino.h>
 #include <LibRobus.h>
 #include <SDState.h>
+#include <Checkpoint.h>
+#include <Profiler.h>
+#include <Scheduler.h>
 
 #define INTEGRATION_ITERATION 50
 #include "RobusDraw.h"
@@ -11,6 +14,7 @@
 #define LABYRINTHE 1
 #define DEFAULTDRAWING 2
 #define SDDRAWING 3
+#define RESUME 4
 
 #define SUCESS_TONE 1500
 #define SUCESS_TONE_DURATION 350
@@ -22,10 +26,34 @@
 #define CHANING_MENU_TONE_DURATION 125
 
 #define PACMAN_CODE_PIN 11
+#define SD_CHIP_SELECT_PIN 10
 
 #define LABYRINTH_COUNT 3
 
+// PWM of the drive motors, see BoardInit()
+#ifndef ROBUS_DRAW_MOTOR_PWM
+#define ROBUS_DRAW_MOTOR_PWM MOTOR_PWM_ARDUINO
+#endif
+
+// Task periods in microseconds
+#define CONTROL_PERIOD 2000
+#define PREFETCH_PERIOD 2000
+#define MUSIC_PERIOD 5000
+#define INTERFACE_PERIOD 10000
+#define SD_PERIOD 10000
+#define CHECKPOINT_TASK_PERIOD 100000
+
 void onSDStateChange(SDState::SDState state);
+void offerResume();
+void handleSerialRequest();
+
+void controlTask();
+void prefetchTask();
+void bluetoothTask();
+void musicTask();
+void interfaceTask();
+void sdTask();
+void checkpointTask();
 void updateButtonState();
 bool isButtonReleased(int button);
 void resultFeedback(bool success);
@@ -38,6 +66,8 @@ int state = DEFAULT;
 
 char pacmanFile[50];
 
+Checkpoint::CheckpointRecord checkpoint;
+
 Note note4[] = {Note(493,125),{987,125},{740,125},{622,125},{987,63},{698,176},{622,250},{523,125},{1046,146},{784,125},{659,125},{1046,63},{784,167},{659,250},{493,125},{987,125},{740,125},{622,125},{987,63},{698,63},{622,63},{659,63},{698,125},{698,63},{740,63},{784,125},{830,63},{880,125},{932,250}};
 Note note2[] = {Note(523, 125), Note(659, 125), Note(784, 125), Note(1046, 250), Note(784, 125), Note(1046, 500)};
 
@@ -45,7 +75,7 @@ bool drawingDone = false;
 
 void setup()
 {
-    BoardInit();
+    BoardInit(ROBUS_DRAW_MOTOR_PWM);
 
     Serial.begin(9600);
     Serial3.begin(115200);
@@ -54,15 +84,39 @@ void setup()
     RobusDraw::setPrecision(0.4);
     RobusPosition::setCurveTightness(50);
     RobusPosition::setFollowAngularVelocityScale(3); //3
+    RobusDraw::setFollowVelocity(6);
     RobusMovement::setPIDAngular(0.5, 0, 0.01, 0);
 
     RobusDraw::initialize();
+#ifdef ROBUS_DRAW_PENCIL_PIPELINING
+    // Turn the carousel and move the pencil while travelling between strokes
+    RobusDraw::setPencilPipelining(true);
+#endif
+
+    unsigned long controlPeriod = CONTROL_PERIOD;
+#ifdef ROBUS_DRAW_CONTROL_INTERRUPT
+    // The LibRobUS interrupt reads the encoders and drives the motors, the
+    // control task runs once per sample
+    controlPeriod = CONTROL_EnableInterrupt(CONTROL_PERIOD);
+    // It shares the SPI bus with the SD card
+    CONTROL_ShareSPI(SD_CHIP_SELECT_PIN);
+#endif
 
     //PACMAN pin
     pinMode(PACMAN_CODE_PIN, INPUT_PULLUP);
 
     SDState::setListener(onSDStateChange);
-    SDState::registerCard(10);
+    SDState::registerCard(SD_CHIP_SELECT_PIN);
+
+    // The control task has the highest priority and a fixed period, the
+    // rest runs in the time left, Bluetooth whenever nothing else is due
+    Scheduler::addTask("control", controlTask, controlPeriod, 0);
+    Scheduler::addTask("prefetch", prefetchTask, PREFETCH_PERIOD, 1);
+    Scheduler::addTask("music", musicTask, MUSIC_PERIOD, 2);
+    Scheduler::addTask("ui", interfaceTask, INTERFACE_PERIOD, 3);
+    Scheduler::addTask("sd", sdTask, SD_PERIOD, 3);
+    Scheduler::addTask("checkpoint", checkpointTask, CHECKPOINT_TASK_PERIOD, 3);
+    Scheduler::addTask("bluetooth", bluetoothTask, 0, 4);
 
     //Init random
     randomSeed(analogRead(A0));
@@ -73,11 +127,36 @@ void onSDStateChange(SDState::SDState state) {
 
     if (state == SDState::PRESENT) {
         Serial.println("Successfully initialized SD card!");
+        offerResume();
     } else {
+        // The files are closed before the card is initialized again
+        RobusDraw::stopDrawing();
+        Checkpoint::end();
         Serial.println("Failed to initialize SD card!");
     }
 }
 
+void offerResume() {
+    if (!Checkpoint::begin() || RobusDraw::isDrawingLoaded() || !Checkpoint::load(checkpoint)) {
+        return;
+    }
+
+    Serial.print("Unfinished drawing ");
+    Serial.print(checkpoint.drawingName);
+    Serial.print(" at point ");
+    Serial.println(checkpoint.pointIndex);
+    // The odometry starts over at power-up, so the drawing can only go on from the saved pose
+    Serial.print("Put the robot back on that point at x ");
+    Serial.print(checkpoint.x);
+    Serial.print(", y ");
+    Serial.print(checkpoint.y);
+    Serial.print(", heading ");
+    Serial.print(checkpoint.orientation * RAD_TO_DEG);
+    Serial.println(" deg, then FRONT to resume, REAR to discard");
+    state = RESUME;
+    changeMenuFeedback();
+}
+
 bool loadWithFeedback(char *path) {
     bool success = RobusDraw::loadDrawing(path);
 
@@ -130,9 +209,25 @@ void loopPacman() {
 
 void loop()
 {   
-    SDState::refresh();
-    
+    Scheduler::run();
+}
+
+void controlTask()
+{
+    PROFILE_SECTION("control");
+    RobusDraw::updateDrawing();
+    RobusPosition::update();
+}
+
+void prefetchTask()
+{
+    RobusDraw::updatePrefetch();
+}
+
+void bluetoothTask()
+{
     if (SDState::isCardPresent()) {
+        PROFILE_SECTION("bluetooth");
         BluetoothDraw::ReadingState bluetoothState = BluetoothDraw::update();
         if (bluetoothState == BluetoothDraw::ReadingState::DONE) {
             setSong(note4, 29, false);
@@ -141,12 +236,49 @@ void loop()
              AX_BuzzerON(FAILURE_TONE, FAILURE_TONE_DURATION);
         }
     }
+}
+
+void musicTask()
+{
+    PROFILE_SECTION("music");
+    play();
+}
+
+void sdTask()
+{
+    PROFILE_SECTION("sd");
+    SDState::refresh();
+}
 
+void checkpointTask()
+{
+    PROFILE_SECTION("checkpoint");
+    Checkpoint::update();
+}
+
+void interfaceTask()
+{
+    PROFILE_SECTION("ui");
+    handleSerialRequest();
     updateButtonState();
-    delay(2);
 
     switch (state)
     {
+    case RESUME:
+        if (isButtonReleased(FRONT))
+        {
+            resultFeedback(Checkpoint::resume(checkpoint));
+            state = DEFAULT;
+        }
+
+        if (isButtonReleased(REAR))
+        {
+            Checkpoint::clear();
+            changeMenuFeedback();
+            state = DEFAULT;
+        }
+        break;
+
     case LABYRINTHE:
 
         if (isButtonReleased(LEFT))
@@ -266,9 +398,32 @@ void loop()
     }
 
     drawingDone = RobusDraw::isDrawingFinished();
-    
-    RobusDraw::update();
-    play();
+}
+
+/**
+ * Sending 's' on the USB serial prints the scheduler statistics. With
+ * ROBUS_DRAW_PROFILING, 'p' prints the profile and 'r' clears it.
+ */
+void handleSerialRequest()
+{
+    if (Serial.available() > 0)
+    {
+        int request = Serial.read();
+        if (request == 's')
+        {
+            Scheduler::dump(Serial);
+        }
+#ifdef ROBUS_DRAW_PROFILING
+        else if (request == 'p')
+        {
+            PROFILE_DUMP(Serial);
+        }
+        else if (request == 'r')
+        {
+            PROFILE_RESET();
+        }
+#endif
+    }
 }
 
 void updateButtonState()
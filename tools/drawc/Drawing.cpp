@@ -0,0 +1,419 @@
+/**
+ * @file Drawing.cpp
+ * @brief Host-side reading, validation and writing of RobusDraw drawings.
+ *
+ * The text reader accepts the same DRAWING_INFO / SETTINGS / DRAWING layout
+ * as RobusDraw::loadDrawing(), but reports every problem with its line number
+ * instead of stopping the robot in the middle of a drawing. Coordinates the
+ * binary format cannot hold are errors too, rather than being clamped when
+ * the drawing is written.
+ */
+
+#include "Drawing.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace DrawingTools {
+    namespace {
+        /**
+         * @brief Size of the line buffer used by loadDrawing() for the info and settings blocks.
+         */
+        const size_t ROBOT_HEADER_LINE_SIZE = 50;
+
+        /**
+         * @brief Size of the line buffer used by loadNextPoint() for the points.
+         */
+        const size_t ROBOT_POINT_LINE_SIZE = 100;
+
+        enum Section {
+            OUTSIDE,
+            INFO,
+            SETTINGS,
+            POINTS,
+            DONE
+        };
+
+        void report(std::vector<Diagnostic>& diagnostics, Diagnostic::Severity severity, int line, const std::string& message) {
+            diagnostics.push_back({severity, line, message});
+        }
+
+        std::string trim(const std::string& text) {
+            size_t start = text.find_first_not_of(" \t");
+            if (start == std::string::npos) {
+                return "";
+            }
+            size_t end = text.find_last_not_of(" \t");
+            return text.substr(start, end - start + 1);
+        }
+
+        bool parseNumber(const std::string& text, float& value) {
+            char* end = nullptr;
+            value = strtof(text.c_str(), &end);
+            return !text.empty() && end != nullptr && *end == '\0';
+        }
+
+        bool isInBinaryRange(float value) {
+            // Also false for the infinities and NaN strtof() accepts
+            return fabsf(value) < DRAWING_BINARY_MAX_COORDINATE + 0.5f;
+        }
+
+        bool parseColor(const std::string& text, PencilColor& color) {
+            for (int candidate = RED; candidate <= NONE; candidate++) {
+                if (text == pencilColorToString((PencilColor) candidate)) {
+                    color = (PencilColor) candidate;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::vector<std::string> tokenize(const std::string& text) {
+            std::vector<std::string> tokens;
+            size_t start = 0;
+            while (start < text.size()) {
+                size_t end = text.find(' ', start);
+                if (end == std::string::npos) {
+                    end = text.size();
+                }
+                if (end > start) {
+                    tokens.push_back(text.substr(start, end - start));
+                }
+                start = end + 1;
+            }
+            return tokens;
+        }
+
+        std::string formatNumber(float value) {
+            char buffer[32];
+            snprintf(buffer, sizeof(buffer), "%.6g", value);
+            return buffer;
+        }
+
+        void readInfoLine(const std::string& key, const std::string& value, int lineNumber, Drawing& drawing, std::vector<Diagnostic>& diagnostics) {
+            float number;
+            if (key == "name") {
+                if (value.size() >= sizeof(drawing.info.name)) {
+                    report(diagnostics, Diagnostic::ERROR, lineNumber, "name is longer than " + std::to_string(sizeof(drawing.info.name) - 1) + " characters");
+                }
+                snprintf(drawing.info.name, sizeof(drawing.info.name), "%s", value.c_str());
+            } else if (key == "width" && parseNumber(value, number)) {
+                drawing.info.width = number;
+            } else if (key == "height" && parseNumber(value, number)) {
+                drawing.info.height = number;
+            } else if (key == "pointsCount" && parseNumber(value, number) && number >= 0 && number == (int) number) {
+                drawing.info.pointsCount = (int) number;
+            } else if (key == "width" || key == "height" || key == "pointsCount") {
+                report(diagnostics, Diagnostic::ERROR, lineNumber, "invalid value '" + value + "' for " + key);
+            } else {
+                report(diagnostics, Diagnostic::WARNING, lineNumber, "unknown info key '" + key + "'");
+            }
+        }
+
+        void readSettingsLine(const std::string& key, const std::string& value, int lineNumber, Drawing& drawing, std::vector<Diagnostic>& diagnostics) {
+            float* target = nullptr;
+            if (key == "followAngularVelocityScale") {
+                target = &drawing.settings.followAngularVelocityScale;
+            } else if (key == "followVelocity") {
+                target = &drawing.settings.followVelocity;
+            } else if (key == "curveTightness") {
+                target = &drawing.settings.curveTightness;
+            } else {
+                report(diagnostics, Diagnostic::WARNING, lineNumber, "unknown setting '" + key + "'");
+                return;
+            }
+
+            if (!parseNumber(value, *target)) {
+                report(diagnostics, Diagnostic::ERROR, lineNumber, "invalid value '" + value + "' for " + key);
+            }
+        }
+
+        void readPointLine(const std::string& line, int lineNumber, Drawing& drawing, std::vector<Diagnostic>& diagnostics) {
+            std::vector<std::string> tokens = tokenize(line);
+            if (tokens.size() != 4) {
+                report(diagnostics, Diagnostic::ERROR, lineNumber, "expected 'x y COLOR true|false', got '" + line + "'");
+                return;
+            }
+
+            RobusDraw::DrawingPoint point = {};
+            bool valid = true;
+
+            if (!parseNumber(tokens[0], point.x) || !parseNumber(tokens[1], point.y)) {
+                report(diagnostics, Diagnostic::ERROR, lineNumber, "invalid coordinates '" + tokens[0] + " " + tokens[1] + "'");
+                valid = false;
+            } else if (!isInBinaryRange(point.x) || !isInBinaryRange(point.y)) {
+                report(diagnostics, Diagnostic::ERROR, lineNumber, "coordinates '" + tokens[0] + " " + tokens[1] + "' are out of the binary format's range of +-" + std::to_string(DRAWING_BINARY_MAX_COORDINATE));
+                valid = false;
+            }
+
+            if (!parseColor(tokens[2], point.color)) {
+                report(diagnostics, Diagnostic::ERROR, lineNumber, "unknown color '" + tokens[2] + "'");
+                valid = false;
+            }
+
+            if (tokens[3] == "true" || tokens[3] == "false") {
+                point.isBoundary = tokens[3] == "true";
+            } else {
+                report(diagnostics, Diagnostic::ERROR, lineNumber, "boundary flag must be 'true' or 'false', got '" + tokens[3] + "'");
+                valid = false;
+            }
+
+            if (valid) {
+                drawing.points.push_back(point);
+            }
+        }
+    }
+
+    /**
+     * @brief Reads a text drawing, reporting syntax problems as it goes.
+     * @param input The stream holding the text drawing.
+     * @param drawing Receives the drawing.
+     * @param diagnostics Receives the problems found.
+     * @return True if the info, settings and drawing blocks were all found.
+     */
+    bool readTextDrawing(std::istream& input, Drawing& drawing, std::vector<Diagnostic>& diagnostics) {
+        bool infoFound = false;
+        bool settingsFound = false;
+        bool pointsFound = false;
+        bool carriageReturnReported = false;
+
+        Section section = OUTSIDE;
+        std::string line;
+        int lineNumber = 0;
+
+        while (std::getline(input, line)) {
+            lineNumber++;
+
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+                if (!carriageReturnReported) {
+                    report(diagnostics, Diagnostic::WARNING, lineNumber, "CRLF line endings are not understood by the robot's text parser");
+                    carriageReturnReported = true;
+                }
+            }
+
+            size_t limit = section == POINTS ? ROBOT_POINT_LINE_SIZE : ROBOT_HEADER_LINE_SIZE;
+            if (line.size() >= limit) {
+                report(diagnostics, Diagnostic::ERROR, lineNumber, "line is longer than the robot's " + std::to_string(limit) + " byte line buffer");
+            }
+
+            if (section == POINTS) {
+                if (line == "DRAWING_END") {
+                    section = DONE;
+                } else if (!trim(line).empty()) {
+                    readPointLine(line, lineNumber, drawing, diagnostics);
+                }
+                continue;
+            }
+
+            if (line == "DRAWING_INFO_START") {
+                section = INFO;
+            } else if (line == "DRAWING_INFO_END" && section == INFO) {
+                section = OUTSIDE;
+                infoFound = true;
+            } else if (line == "SETTINGS_START") {
+                section = SETTINGS;
+            } else if (line == "SETTINGS_END" && section == SETTINGS) {
+                section = OUTSIDE;
+                settingsFound = true;
+            } else if (line == "DRAWING_START") {
+                if (!infoFound || !settingsFound) {
+                    report(diagnostics, Diagnostic::ERROR, lineNumber, "DRAWING_START must come after the info and settings blocks");
+                }
+                section = POINTS;
+                pointsFound = true;
+            } else if (section == INFO || section == SETTINGS) {
+                size_t equal = line.find('=');
+                if (equal == std::string::npos) {
+                    report(diagnostics, Diagnostic::ERROR, lineNumber, "expected 'key = value', got '" + line + "'");
+                    continue;
+                }
+                if (line.compare(equal, 2, "= ") != 0) {
+                    report(diagnostics, Diagnostic::ERROR, lineNumber, "the robot expects a single space after '='");
+                }
+
+                std::string key = trim(line.substr(0, equal));
+                std::string value = trim(line.substr(equal + 1));
+                if (section == INFO) {
+                    readInfoLine(key, value, lineNumber, drawing, diagnostics);
+                } else {
+                    readSettingsLine(key, value, lineNumber, drawing, diagnostics);
+                }
+            }
+        }
+
+        if (!infoFound) {
+            report(diagnostics, Diagnostic::ERROR, 0, "missing DRAWING_INFO_START / DRAWING_INFO_END block");
+        }
+        if (!settingsFound) {
+            report(diagnostics, Diagnostic::ERROR, 0, "missing SETTINGS_START / SETTINGS_END block");
+        }
+        if (!pointsFound) {
+            report(diagnostics, Diagnostic::ERROR, 0, "missing DRAWING_START block");
+        } else if (section != DONE) {
+            report(diagnostics, Diagnostic::WARNING, lineNumber, "missing DRAWING_END");
+        }
+
+        return infoFound && settingsFound && pointsFound;
+    }
+
+    /**
+     * @brief Checks the consistency of a drawing that was read successfully.
+     * @param drawing The drawing to check.
+     * @param diagnostics Receives the problems found.
+     */
+    void validateDrawing(const Drawing& drawing, std::vector<Diagnostic>& diagnostics) {
+        int pointsCount = drawing.points.size();
+        if (drawing.info.pointsCount != pointsCount) {
+            report(diagnostics, Diagnostic::ERROR, 0, "pointsCount is " + std::to_string(drawing.info.pointsCount) + " but the drawing has " + std::to_string(pointsCount) + " points");
+        }
+
+        if (isnan(drawing.settings.followAngularVelocityScale)) {
+            report(diagnostics, Diagnostic::WARNING, 0, "followAngularVelocityScale is not set");
+        }
+        if (isnan(drawing.settings.followVelocity)) {
+            report(diagnostics, Diagnostic::WARNING, 0, "followVelocity is not set");
+        }
+        if (isnan(drawing.settings.curveTightness)) {
+            report(diagnostics, Diagnostic::WARNING, 0, "curveTightness is not set");
+        }
+
+        int boundaries = 0;
+        for (const RobusDraw::DrawingPoint& point : drawing.points) {
+            if (point.isBoundary) {
+                boundaries++;
+            }
+        }
+        if (boundaries % 2 != 0) {
+            report(diagnostics, Diagnostic::ERROR, 0, "unbalanced boundaries: " + std::to_string(boundaries) + " points have isBoundary set, the last stroke never ends");
+        }
+    }
+
+    /**
+     * @brief Writes a drawing in the text format read by RobusDraw::loadDrawing().
+     * @param output The stream receiving the drawing.
+     * @param drawing The drawing to write.
+     * @param offsets Receives the byte offset of every point line, if not null.
+     */
+    void writeTextDrawing(std::ostream& output, const Drawing& drawing, std::vector<uint32_t>* offsets) {
+        output << "DRAWING_INFO_START\n";
+        output << "name = " << drawing.info.name << "\n";
+        output << "width = " << formatNumber(drawing.info.width) << "\n";
+        output << "height = " << formatNumber(drawing.info.height) << "\n";
+        output << "pointsCount = " << drawing.points.size() << "\n";
+        output << "DRAWING_INFO_END\n";
+
+        output << "SETTINGS_START\n";
+        output << "followAngularVelocityScale = " << formatNumber(drawing.settings.followAngularVelocityScale) << "\n";
+        output << "followVelocity = " << formatNumber(drawing.settings.followVelocity) << "\n";
+        output << "curveTightness = " << formatNumber(drawing.settings.curveTightness) << "\n";
+        output << "SETTINGS_END\n";
+
+        output << "DRAWING_START\n";
+        for (const RobusDraw::DrawingPoint& point : drawing.points) {
+            if (offsets != nullptr) {
+                offsets->push_back(output.tellp());
+            }
+            output << formatNumber(point.x) << " " << formatNumber(point.y) << " " << pencilColorToString(point.color) << " " << (point.isBoundary ? "true" : "false") << "\n";
+        }
+        output << "DRAWING_END\n";
+    }
+
+    /**
+     * @brief Writes a drawing in the compact binary format, followed by its point index.
+     * @param output The stream receiving the drawing.
+     * @param drawing The drawing to write.
+     */
+    void writeBinaryDrawing(std::ostream& output, const Drawing& drawing) {
+        float maxMagnitude = 0;
+        for (const RobusDraw::DrawingPoint& point : drawing.points) {
+            maxMagnitude = fmaxf(maxMagnitude, fmaxf(fabsf(point.x), fabsf(point.y)));
+        }
+
+        RobusDraw::BinaryLayout layout;
+        layout.coordinateShift = RobusDraw::coordinateShiftFor(maxMagnitude);
+
+        RobusDraw::DrawingInfo info = drawing.info;
+        info.pointsCount = drawing.points.size();
+
+        uint8_t header[DRAWING_BINARY_HEADER_SIZE];
+        RobusDraw::encodeBinaryHeader(header, info, drawing.settings, layout);
+        output.write((const char*) header, sizeof(header));
+
+        for (const RobusDraw::DrawingPoint& point : drawing.points) {
+            uint8_t record[DRAWING_BINARY_RECORD_SIZE];
+            RobusDraw::encodeBinaryPoint(record, layout, point);
+            output.write((const char*) record, sizeof(record));
+        }
+
+        std::vector<uint32_t> offsets;
+        for (size_t i = 0; i < drawing.points.size(); i++) {
+            offsets.push_back(DRAWING_BINARY_HEADER_SIZE + i * DRAWING_BINARY_RECORD_SIZE);
+        }
+        writeIndex(output, drawing, offsets, DRAWING_BINARY_HEADER_SIZE + drawing.points.size() * DRAWING_BINARY_RECORD_SIZE);
+    }
+
+    /**
+     * @brief Writes the point index of a drawing.
+     *
+     * The pen state of every indexed point follows RobusDraw::loadNextPoint():
+     * the pen is up on the first point and toggles after every boundary.
+     *
+     * @param output The stream receiving the index.
+     * @param drawing The indexed drawing.
+     * @param offsets The byte offset of every point in the drawing file.
+     * @param dataSize The size of the drawing data the offsets refer to.
+     */
+    void writeIndex(std::ostream& output, const Drawing& drawing, const std::vector<uint32_t>& offsets, uint32_t dataSize) {
+        RobusDraw::IndexHeader header;
+        header.pointsCount = drawing.points.size();
+        header.dataSize = dataSize;
+
+        uint8_t buffer[DRAWING_INDEX_HEADER_SIZE];
+        RobusDraw::encodeIndexHeader(buffer, header);
+        output.write((const char*) buffer, sizeof(buffer));
+
+        bool inLine = false;
+        for (size_t i = 0; i < drawing.points.size(); i++) {
+            if (i > 0 && drawing.points[i - 1].isBoundary) {
+                inLine = !inLine;
+            }
+
+            if (i % header.interval == 0) {
+                uint8_t record[DRAWING_INDEX_ENTRY_SIZE];
+                RobusDraw::encodeIndexEntry(record, {offsets[i], inLine});
+                output.write((const char*) record, sizeof(record));
+            }
+        }
+    }
+
+    /**
+     * @brief Checks if a list of diagnostics contains an error.
+     * @param diagnostics The diagnostics to check.
+     * @return True if at least one diagnostic is an error.
+     */
+    bool hasErrors(const std::vector<Diagnostic>& diagnostics) {
+        for (const Diagnostic& diagnostic : diagnostics) {
+            if (diagnostic.severity == Diagnostic::ERROR) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Prints diagnostics in the usual "file:line: severity: message" form.
+     * @param output The stream receiving the diagnostics.
+     * @param path The name of the file the diagnostics refer to.
+     * @param diagnostics The diagnostics to print.
+     */
+    void printDiagnostics(std::ostream& output, const char* path, const std::vector<Diagnostic>& diagnostics) {
+        for (const Diagnostic& diagnostic : diagnostics) {
+            output << path;
+            if (diagnostic.line > 0) {
+                output << ":" << diagnostic.line;
+            }
+            output << ": " << (diagnostic.severity == Diagnostic::ERROR ? "error" : "warning") << ": " << diagnostic.message << "\n";
+        }
+    }
+}
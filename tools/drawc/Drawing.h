@@ -0,0 +1,40 @@
+#ifndef DRAWC_DRAWING_H
+#define DRAWC_DRAWING_H
+
+#include <DrawingFormat.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace DrawingTools {
+
+    struct Drawing {
+        RobusDraw::DrawingInfo info = {};
+        RobusDraw::DrawingSettings settings;
+        std::vector<RobusDraw::DrawingPoint> points;
+    };
+
+    struct Diagnostic {
+        enum Severity {
+            WARNING,
+            ERROR
+        };
+
+        Severity severity;
+        int line; /**< Line of the source file, 0 when the problem concerns the whole drawing. */
+        std::string message;
+    };
+
+    bool readTextDrawing(std::istream& input, Drawing& drawing, std::vector<Diagnostic>& diagnostics);
+    void validateDrawing(const Drawing& drawing, std::vector<Diagnostic>& diagnostics);
+
+    void writeTextDrawing(std::ostream& output, const Drawing& drawing, std::vector<uint32_t>* offsets = nullptr);
+    void writeBinaryDrawing(std::ostream& output, const Drawing& drawing);
+    void writeIndex(std::ostream& output, const Drawing& drawing, const std::vector<uint32_t>& offsets, uint32_t dataSize);
+
+    bool hasErrors(const std::vector<Diagnostic>& diagnostics);
+    void printDiagnostics(std::ostream& output, const char* path, const std::vector<Diagnostic>& diagnostics);
+}
+
+#endif // DRAWC_DRAWING_H
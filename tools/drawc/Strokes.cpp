@@ -0,0 +1,566 @@
+/**
+ * @file Strokes.cpp
+ * @brief Splitting a drawing into strokes and reordering them to shorten pen-up travel and color changes.
+ *
+ * The pen state follows the rules of RobusDraw::loadNextPoint(): the robot
+ * starts at the origin with the pen up, and the pen toggles when the robot
+ * leaves a point whose isBoundary flag is set. A stroke therefore runs from
+ * one boundary point to the next, and the points between strokes are only
+ * pen-up waypoints that reordering is free to drop.
+ */
+
+#include "Strokes.h"
+
+#include <PathSimplifier.h>
+
+#include <algorithm>
+#include <limits.h>
+
+using RobusDraw::DrawingPoint;
+
+namespace DrawingTools {
+    namespace {
+        /**
+         * @brief Largest number of improvement passes of the 2-opt search.
+         */
+        const int MAX_TWO_OPT_PASSES = 50;
+
+        /**
+         * @brief Smallest distance gain for which the 2-opt search applies a move.
+         */
+        const float MIN_GAIN = 1e-4;
+
+        const DrawingPoint ORIGIN = {0, 0, NONE, false};
+
+        float distance(const DrawingPoint& a, const DrawingPoint& b) {
+            return hypotf(a.x - b.x, a.y - b.y);
+        }
+
+        /**
+         * @brief Strokes that must be drawn before others: precedence[a][b] is set when a must come before b.
+         *
+         * Empty when the strokes can go in any order.
+         */
+        typedef std::vector<std::vector<bool>> Precedence;
+
+        bool mustPrecede(const Precedence& precedence, int a, int b) {
+            return !precedence.empty() && precedence[a][b];
+        }
+
+        /**
+         * @brief Checks if every stroke that must come before a stroke is already drawn.
+         */
+        bool isReady(const Precedence& precedence, const std::vector<bool>& used, int stroke) {
+            for (size_t i = 0; i < used.size(); i++) {
+                if (!used[i] && mustPrecede(precedence, i, stroke)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Orders the strokes by always going to the closest end of a stroke that is ready.
+         * @param strokes The strokes to reorder.
+         * @param ids Receives, for every stroke in the new order, its position in the old one.
+         * @param start Where the robot is before the first stroke.
+         * @param precedence The precedence between the strokes, in their old order.
+         */
+        void nearestNeighbour(std::vector<Stroke>& strokes, std::vector<int>& ids, const DrawingPoint& start, const Precedence& precedence) {
+            std::vector<Stroke> ordered;
+            std::vector<bool> used(strokes.size(), false);
+            DrawingPoint position = start;
+            ids.clear();
+
+            for (size_t step = 0; step < strokes.size(); step++) {
+                size_t best = 0;
+                bool bestReversed = false;
+                float bestDistance = INFINITY;
+
+                for (size_t i = 0; i < strokes.size(); i++) {
+                    if (used[i] || !isReady(precedence, used, i)) {
+                        continue;
+                    }
+
+                    const Stroke& stroke = strokes[i];
+                    float forward = distance(position, stroke.points.front());
+                    if (forward < bestDistance) {
+                        best = i;
+                        bestReversed = false;
+                        bestDistance = forward;
+                    }
+
+                    float backward = distance(position, stroke.points.back());
+                    if (stroke.reversible && backward < bestDistance) {
+                        best = i;
+                        bestReversed = true;
+                        bestDistance = backward;
+                    }
+                }
+
+                used[best] = true;
+                ids.push_back(best);
+                ordered.push_back(strokes[best]);
+                ordered.back().reversed = bestReversed;
+                position = ordered.back().last();
+            }
+
+            strokes = ordered;
+        }
+
+        /**
+         * @brief Improves the stroke order by reversing runs of strokes while that shortens the travel.
+         *
+         * Reversing the run i..j visits its strokes in the opposite order and
+         * draws each of them backwards, so only the two travel moves around
+         * the run change. Runs holding a stroke that cannot be reversed, or
+         * two strokes that must keep their order, are skipped.
+         *
+         * @param strokes The strokes to reorder.
+         * @param ids The position of every stroke in the order the precedence refers to, kept up to date.
+         * @param start Where the robot is before the first stroke.
+         * @param end Where the robot goes after the last stroke, or nullptr if that is free.
+         * @param precedence The precedence between the strokes.
+         */
+        void twoOpt(std::vector<Stroke>& strokes, std::vector<int>& ids, const DrawingPoint& start, const DrawingPoint* end, const Precedence& precedence) {
+            int count = strokes.size();
+            std::vector<int> fixedBefore(count + 1, 0);
+
+            for (int pass = 0; pass < MAX_TWO_OPT_PASSES; pass++) {
+                for (int i = 0; i < count; i++) {
+                    fixedBefore[i + 1] = fixedBefore[i] + (strokes[i].reversible ? 0 : 1);
+                }
+
+                bool improved = false;
+                for (int i = 0; i < count; i++) {
+                    const DrawingPoint& before = i > 0 ? strokes[i - 1].last() : start;
+
+                    for (int j = i; j < count; j++) {
+                        if (fixedBefore[j + 1] - fixedBefore[i] > 0) {
+                            break;
+                        }
+                        bool ordered = false;
+                        for (int k = i; k < j && !ordered; k++) {
+                            ordered = mustPrecede(precedence, ids[k], ids[j]);
+                        }
+                        if (ordered) {
+                            break;
+                        }
+
+                        float removed = distance(before, strokes[i].first());
+                        float added = distance(before, strokes[j].last());
+
+                        const DrawingPoint* after = nullptr;
+                        if (j + 1 < count) {
+                            after = &strokes[j + 1].first();
+                        } else {
+                            after = end;
+                        }
+                        if (after != nullptr) {
+                            removed += distance(strokes[j].last(), *after);
+                            added += distance(strokes[i].first(), *after);
+                        }
+
+                        if (removed - added > MIN_GAIN) {
+                            std::reverse(strokes.begin() + i, strokes.begin() + j + 1);
+                            std::reverse(ids.begin() + i, ids.begin() + j + 1);
+                            for (int k = i; k <= j; k++) {
+                                strokes[k].reversed = !strokes[k].reversed;
+                            }
+                            improved = true;
+                        }
+                    }
+                }
+
+                if (!improved) {
+                    break;
+                }
+            }
+        }
+
+        void orderStrokes(std::vector<Stroke>& strokes, const DrawingPoint& start, const DrawingPoint* end, const Precedence& precedence = Precedence()) {
+            std::vector<int> ids;
+            nearestNeighbour(strokes, ids, start, precedence);
+            twoOpt(strokes, ids, start, end, precedence);
+        }
+
+        /**
+         * @brief Bit mask of the colors a stroke draws with, one bit per PencilColor.
+         */
+        unsigned drawnColors(const Stroke& stroke) {
+            unsigned colors = 0;
+            for (size_t i = 1; i < stroke.points.size(); i++) {
+                colors |= 1u << stroke.points[i].color;
+            }
+            return colors;
+        }
+
+        struct Bounds {
+            float minX = INFINITY;
+            float minY = INFINITY;
+            float maxX = -INFINITY;
+            float maxY = -INFINITY;
+        };
+
+        Bounds boundsOf(const Stroke& stroke) {
+            Bounds bounds;
+            for (const DrawingPoint& point : stroke.points) {
+                bounds.minX = fminf(bounds.minX, point.x);
+                bounds.minY = fminf(bounds.minY, point.y);
+                bounds.maxX = fmaxf(bounds.maxX, point.x);
+                bounds.maxY = fmaxf(bounds.maxY, point.y);
+            }
+            return bounds;
+        }
+
+        bool overlap(const Bounds& a, const Bounds& b) {
+            return a.minX <= b.maxX && b.minX <= a.maxX && a.minY <= b.maxY && b.minY <= a.maxY;
+        }
+
+        /**
+         * @brief Layering constraints between strokes.
+         *
+         * A stroke must stay after every earlier stroke of another color whose
+         * bounding box overlaps its own, so that it is still drawn over it.
+         * Strokes of the same color can be swapped freely.
+         */
+        struct Layers {
+            std::vector<std::vector<int>> successors;
+            std::vector<int> predecessorCount;
+        };
+
+        Layers findLayers(const std::vector<Stroke>& strokes) {
+            Layers layers;
+            layers.successors.resize(strokes.size());
+            layers.predecessorCount.resize(strokes.size(), 0);
+
+            std::vector<unsigned> colors;
+            std::vector<Bounds> bounds;
+            for (const Stroke& stroke : strokes) {
+                colors.push_back(drawnColors(stroke));
+                bounds.push_back(boundsOf(stroke));
+            }
+
+            for (size_t i = 0; i < strokes.size(); i++) {
+                for (size_t j = i + 1; j < strokes.size(); j++) {
+                    bool sameColor = colors[i] == colors[j] && (colors[i] & (colors[i] - 1)) == 0;
+                    if (!sameColor && overlap(bounds[i], bounds[j])) {
+                        layers.successors[i].push_back(j);
+                        layers.predecessorCount[j]++;
+                    }
+                }
+            }
+            return layers;
+        }
+
+        /**
+         * @brief Orders strokes color by color, following a preferred order of the colors.
+         *
+         * Strokes of the current color are taken as long as one of them has
+         * all its layering predecessors drawn. The schedule then moves on to
+         * the next color of the preference that has a stroke ready. Since
+         * constraints only point forward in file order, the first stroke left
+         * is always ready and the schedule cannot stall.
+         *
+         * @param strokes The strokes, in file order.
+         * @param layers The layering constraints between the strokes.
+         * @param colors The colors in order of preference.
+         * @return The schedule, as runs of stroke indices sharing a color.
+         */
+        std::vector<std::vector<int>> scheduleColors(const std::vector<Stroke>& strokes, const Layers& layers, const std::vector<PencilColor>& colors) {
+            std::vector<std::vector<int>> batches;
+            std::vector<int> remaining = layers.predecessorCount;
+            std::vector<bool> done(strokes.size(), false);
+            size_t scheduled = 0;
+            size_t current = 0;
+
+            while (scheduled < strokes.size()) {
+                std::vector<int> batch;
+                bool progress = true;
+                while (progress) {
+                    progress = false;
+                    for (size_t i = 0; i < strokes.size(); i++) {
+                        if (!done[i] && remaining[i] == 0 && strokes[i].color() == colors[current]) {
+                            done[i] = true;
+                            batch.push_back(i);
+                            for (int successor : layers.successors[i]) {
+                                remaining[successor]--;
+                            }
+                            progress = true;
+                        }
+                    }
+                }
+
+                if (!batch.empty()) {
+                    scheduled += batch.size();
+                    batches.push_back(batch);
+                }
+                current = (current + 1) % colors.size();
+            }
+            return batches;
+        }
+
+        /**
+         * @brief Orders the strokes of every color run for short pen-up travel, one run after the other.
+         *
+         * Strokes mixing several colors can share a run and still overlap, so
+         * the layering constraints between the strokes of a run are kept.
+         *
+         * @param strokes The strokes, in file order.
+         * @param layers The layering constraints between the strokes.
+         * @param batches The runs of stroke indices sharing a color.
+         * @return The strokes in drawing order.
+         */
+        std::vector<Stroke> orderBatches(const std::vector<Stroke>& strokes, const Layers& layers, const std::vector<std::vector<int>>& batches) {
+            std::vector<Stroke> ordered;
+            DrawingPoint position = ORIGIN;
+
+            for (const std::vector<int>& indices : batches) {
+                std::vector<Stroke> batch;
+                Precedence precedence(indices.size(), std::vector<bool>(indices.size(), false));
+                for (size_t i = 0; i < indices.size(); i++) {
+                    batch.push_back(strokes[indices[i]]);
+                    for (size_t j = 0; j < indices.size(); j++) {
+                        const std::vector<int>& successors = layers.successors[indices[i]];
+                        precedence[i][j] = std::find(successors.begin(), successors.end(), indices[j]) != successors.end();
+                    }
+                }
+
+                orderStrokes(batch, position, nullptr, precedence);
+                position = batch.back().last();
+                ordered.insert(ordered.end(), batch.begin(), batch.end());
+            }
+            return ordered;
+        }
+
+        void simplifyRange(const std::vector<DrawingPoint>& points, size_t first, size_t last, float toleranceSquared, std::vector<bool>& keep) {
+            size_t farthest = first;
+            float farthestDistance = 0;
+
+            for (size_t i = first + 1; i < last; i++) {
+                float distance = RobusDraw::segmentDistanceSquared(points[i], points[first], points[last]);
+                if (distance > farthestDistance) {
+                    farthest = i;
+                    farthestDistance = distance;
+                }
+            }
+
+            if (farthestDistance > toleranceSquared) {
+                keep[farthest] = true;
+                simplifyRange(points, first, farthest, toleranceSquared, keep);
+                simplifyRange(points, farthest, last, toleranceSquared, keep);
+            }
+        }
+    }
+
+    /**
+     * @brief Splits a drawing into its pen-down strokes.
+     * @param points The points of the drawing, in file order.
+     * @return The strokes in file order, and the pen-up points after the last stroke.
+     */
+    StrokePlan splitStrokes(const std::vector<DrawingPoint>& points) {
+        StrokePlan plan;
+        Stroke current;
+        bool inLine = false;
+        const DrawingPoint* previous = nullptr;
+
+        for (const DrawingPoint& point : points) {
+            if (previous != nullptr && previous->isBoundary) {
+                inLine = !inLine;
+                if (inLine) {
+                    current = Stroke();
+                    current.points.push_back(*previous);
+                    plan.tail.clear();
+                }
+            }
+
+            if (inLine) {
+                current.points.push_back(point);
+                if (point.isBoundary) {
+                    for (size_t i = 1; i < current.points.size(); i++) {
+                        current.reversible = current.reversible && current.points[i].color == current.color();
+                    }
+                    plan.strokes.push_back(current);
+                }
+            } else if (!point.isBoundary) {
+                plan.tail.push_back(point);
+            }
+
+            previous = &point;
+        }
+
+        return plan;
+    }
+
+    /**
+     * @brief Rebuilds the points of a drawing from its strokes.
+     * The first point of a stroke is reached with the pen up, so it takes
+     * the color of the first segment: the pencil turns during the travel
+     * instead of once more on arrival.
+     *
+     * @param plan The strokes to draw, in order and orientation.
+     * @return The points, with isBoundary set on the ends of every stroke.
+     */
+    std::vector<DrawingPoint> joinStrokes(const StrokePlan& plan) {
+        std::vector<DrawingPoint> points;
+
+        for (const Stroke& stroke : plan.strokes) {
+            size_t size = stroke.points.size();
+            for (size_t i = 0; i < size; i++) {
+                DrawingPoint point = stroke.points[stroke.reversed ? size - 1 - i : i];
+                point.isBoundary = i == 0 || i == size - 1;
+                if (i == 0 && size > 1) {
+                    point.color = stroke.points[stroke.reversed ? size - 2 : 1].color;
+                }
+                points.push_back(point);
+            }
+        }
+
+        points.insert(points.end(), plan.tail.begin(), plan.tail.end());
+        return points;
+    }
+
+    /**
+     * @brief Computes the distance the robot travels with the pen up.
+     * @param points The points of the drawing, in order.
+     * @return The pen-up distance, starting from the origin.
+     */
+    float penUpDistance(const std::vector<DrawingPoint>& points) {
+        float total = 0;
+        bool inLine = false;
+        DrawingPoint previous = ORIGIN;
+
+        for (const DrawingPoint& point : points) {
+            if (previous.isBoundary) {
+                inLine = !inLine;
+            }
+            if (!inLine) {
+                total += distance(previous, point);
+            }
+            previous = point;
+        }
+
+        return total;
+    }
+
+    /**
+     * @brief Reorders and reverses strokes to shorten the pen-up travel between them.
+     *
+     * A nearest-neighbour tour from the origin is refined with 2-opt moves.
+     * Strokes mixing several colors keep their direction.
+     *
+     * @param plan The strokes to reorder.
+     */
+    void optimizeTravel(StrokePlan& plan) {
+        orderStrokes(plan.strokes, ORIGIN, plan.tail.empty() ? nullptr : &plan.tail.front());
+    }
+
+    /**
+     * @brief Computes the time RobusDraw waits on the color servo while drawing.
+     *
+     * Follows setPencilColor(): the pencil starts on BLACK and every loaded
+     * point turns it to its own color.
+     *
+     * @param points The points of the drawing, in order.
+     * @return The time in milliseconds.
+     */
+    unsigned long colorChangeTime(const std::vector<DrawingPoint>& points) {
+        unsigned long total = 0;
+        PencilColor color = BLACK;
+
+        for (const DrawingPoint& point : points) {
+            if (pencilColorToAngle(point.color) != pencilColorToAngle(color)) {
+                total += pencilColorChangeTime(color, point.color);
+                color = point.color;
+            }
+        }
+        return total;
+    }
+
+    /**
+     * @brief Groups strokes by color to shorten the time spent turning the color servo.
+     *
+     * Every order of the colors used is tried as a preference for the
+     * scheduling, with the strokes of each color run ordered for short
+     * pen-up travel. The candidate with the shortest color change time
+     * wins, then the one with the shortest pen-up travel; the file order
+     * is kept unless a candidate beats it. A stroke is never moved before
+     * an earlier stroke of another color it overlaps.
+     *
+     * @param plan The strokes to reorder, in file order.
+     */
+    void batchColors(StrokePlan& plan) {
+        std::vector<PencilColor> colors;
+        for (const Stroke& stroke : plan.strokes) {
+            if (std::find(colors.begin(), colors.end(), stroke.color()) == colors.end()) {
+                colors.push_back(stroke.color());
+            }
+        }
+        if (colors.empty()) {
+            return;
+        }
+        std::sort(colors.begin(), colors.end());
+
+        Layers layers = findLayers(plan.strokes);
+        std::vector<DrawingPoint> points = joinStrokes(plan);
+        std::vector<Stroke> best = plan.strokes;
+        unsigned long bestTime = colorChangeTime(points);
+        float bestDistance = penUpDistance(points);
+
+        do {
+            StrokePlan candidate = {orderBatches(plan.strokes, layers, scheduleColors(plan.strokes, layers, colors)), plan.tail};
+            points = joinStrokes(candidate);
+            unsigned long time = colorChangeTime(points);
+            float distance = penUpDistance(points);
+            if (time < bestTime || (time == bestTime && bestDistance - distance > MIN_GAIN)) {
+                best = candidate.strokes;
+                bestTime = time;
+                bestDistance = distance;
+            }
+        } while (std::next_permutation(colors.begin(), colors.end()));
+
+        plan.strokes = best;
+    }
+
+    /**
+     * @brief Removes nearly collinear points from every stroke with the Ramer-Douglas-Peucker algorithm.
+     *
+     * The last point of every color run is kept, so each segment keeps the
+     * color it was drawn with. The points after the last stroke are left
+     * as they are.
+     *
+     * @param plan The strokes to simplify.
+     * @param tolerance The largest distance between a removed point and the simplified stroke.
+     * @return The number of points removed.
+     */
+    size_t simplifyStrokes(StrokePlan& plan, float tolerance) {
+        size_t removed = 0;
+
+        for (Stroke& stroke : plan.strokes) {
+            const std::vector<DrawingPoint>& points = stroke.points;
+            std::vector<bool> keep(points.size(), false);
+            keep.front() = true;
+            keep.back() = true;
+
+            size_t first = 0;
+            for (size_t i = 1; i < points.size(); i++) {
+                bool runEnd = i + 1 == points.size() || points[i + 1].color != points[i].color;
+                if (runEnd) {
+                    keep[i] = true;
+                    simplifyRange(points, first, i, tolerance * tolerance, keep);
+                    first = i;
+                }
+            }
+
+            std::vector<DrawingPoint> simplified;
+            for (size_t i = 0; i < points.size(); i++) {
+                if (keep[i]) {
+                    simplified.push_back(points[i]);
+                }
+            }
+            removed += points.size() - simplified.size();
+            stroke.points = simplified;
+        }
+        return removed;
+    }
+}
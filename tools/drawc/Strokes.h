@@ -0,0 +1,42 @@
+#ifndef DRAWC_STROKES_H
+#define DRAWC_STROKES_H
+
+#include "Drawing.h"
+
+namespace DrawingTools {
+
+    /**
+     * @brief A pen-down run of points, from one isBoundary point to the next.
+     */
+    struct Stroke {
+        std::vector<RobusDraw::DrawingPoint> points;
+        bool reversed = false;
+        bool reversible = true; /**< False when the stroke draws with several colors, since each segment takes the color of its end point. */
+
+        const RobusDraw::DrawingPoint& first() const { return reversed ? points.back() : points.front(); }
+        const RobusDraw::DrawingPoint& last() const { return reversed ? points.front() : points.back(); }
+        PencilColor color() const { return points.back().color; }
+    };
+
+    /**
+     * @brief A drawing split into strokes, with the pen-up points that follow the last stroke.
+     */
+    struct StrokePlan {
+        std::vector<Stroke> strokes;
+        std::vector<RobusDraw::DrawingPoint> tail;
+    };
+
+    StrokePlan splitStrokes(const std::vector<RobusDraw::DrawingPoint>& points);
+    std::vector<RobusDraw::DrawingPoint> joinStrokes(const StrokePlan& plan);
+
+    float penUpDistance(const std::vector<RobusDraw::DrawingPoint>& points);
+
+    unsigned long colorChangeTime(const std::vector<RobusDraw::DrawingPoint>& points);
+
+    void optimizeTravel(StrokePlan& plan);
+    void batchColors(StrokePlan& plan);
+
+    size_t simplifyStrokes(StrokePlan& plan, float tolerance);
+}
+
+#endif // DRAWC_STROKES_H
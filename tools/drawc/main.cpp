@@ -0,0 +1,154 @@
+/**
+ * @file main.cpp
+ * @brief Offline drawing compiler.
+ *
+ * Usage: drawc <input.txt> [-o output] [--text] [--check] [--optimize-travel] [--batch-colors] [--simplify precision]
+ *
+ * Reads a text drawing, validates it and writes it in the compact binary
+ * format understood by RobusDraw::loadDrawing(). The output defaults to the
+ * input name with a .BIN extension. --text writes the validated drawing back
+ * in the text format instead and needs an explicit -o, and writes the point
+ * index next to it with the DRAWING_INDEX_EXTENSION extension; binary
+ * drawings carry their index after the points. --check only validates.
+ * --optimize-travel reorders and reverses the strokes to shorten the pen-up
+ * moves between them before writing, regardless of their colors.
+ * --batch-colors instead groups the strokes by color to save pencil changes,
+ * keeping overlapping strokes of different colors in their original order,
+ * and shortens the travel within each group.
+ * --simplify drops the nearly collinear points of every stroke, within
+ * DRAWING_SIMPLIFY_FACTOR of the precision the robot will draw with.
+ */
+
+#include "Drawing.h"
+#include "Strokes.h"
+
+#include <PathSimplifier.h>
+
+#include <fstream>
+#include <string.h>
+
+using namespace DrawingTools;
+
+namespace {
+    struct Options {
+        const char* input = nullptr;
+        std::string output;
+        bool text = false;
+        bool checkOnly = false;
+        bool optimizeTravel = false;
+        bool batchColors = false;
+        float simplifyPrecision = 0;
+    };
+
+    bool parseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+                options.output = argv[++i];
+            } else if (strcmp(argv[i], "--text") == 0) {
+                options.text = true;
+            } else if (strcmp(argv[i], "--check") == 0) {
+                options.checkOnly = true;
+            } else if (strcmp(argv[i], "--optimize-travel") == 0) {
+                options.optimizeTravel = true;
+            } else if (strcmp(argv[i], "--batch-colors") == 0) {
+                options.batchColors = true;
+            } else if (strcmp(argv[i], "--simplify") == 0 && i + 1 < argc) {
+                options.simplifyPrecision = atof(argv[++i]);
+            } else if (argv[i][0] != '-' && options.input == nullptr) {
+                options.input = argv[i];
+            } else {
+                return false;
+            }
+        }
+        return options.input != nullptr && (!options.text || !options.output.empty() || options.checkOnly);
+    }
+
+    std::string defaultOutput(const std::string& input) {
+        size_t slash = input.find_last_of("/\\");
+        size_t dot = input.find_last_of('.');
+        std::string stem = dot != std::string::npos && (slash == std::string::npos || dot > slash) ? input.substr(0, dot) : input;
+        return stem + ".BIN";
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: " << argv[0] << " <input.txt> [-o output] [--text] [--check] [--optimize-travel] [--batch-colors] [--simplify precision]\n";
+        return 2;
+    }
+
+    std::ifstream input(options.input);
+    if (!input) {
+        std::cerr << "drawc: cannot open " << options.input << "\n";
+        return 2;
+    }
+
+    Drawing drawing;
+    std::vector<Diagnostic> diagnostics;
+    if (readTextDrawing(input, drawing, diagnostics)) {
+        validateDrawing(drawing, diagnostics);
+    }
+    printDiagnostics(std::cerr, options.input, diagnostics);
+
+    if (hasErrors(diagnostics)) {
+        return 1;
+    }
+
+    std::cerr << options.input << ": " << drawing.points.size() << " points\n";
+
+    if (options.optimizeTravel || options.batchColors || options.simplifyPrecision > 0) {
+        StrokePlan plan = splitStrokes(drawing.points);
+        float travelBefore = penUpDistance(drawing.points);
+        unsigned long colorBefore = colorChangeTime(drawing.points);
+
+        if (options.simplifyPrecision > 0) {
+            size_t removed = simplifyStrokes(plan, options.simplifyPrecision * DRAWING_SIMPLIFY_FACTOR);
+            std::cerr << options.input << ": simplification removed " << removed << " points\n";
+        }
+
+        if (options.batchColors) {
+            batchColors(plan);
+        } else if (options.optimizeTravel) {
+            optimizeTravel(plan);
+        }
+        drawing.points = joinStrokes(plan);
+        drawing.info.pointsCount = drawing.points.size();
+
+        std::cerr << options.input << ": " << plan.strokes.size() << " strokes, pen-up travel " << travelBefore << " -> " << penUpDistance(drawing.points)
+                  << ", color changes " << colorBefore << " -> " << colorChangeTime(drawing.points) << " ms\n";
+    }
+
+    if (options.checkOnly) {
+        return 0;
+    }
+
+    if (options.output.empty()) {
+        options.output = defaultOutput(options.input);
+    }
+
+    std::ofstream output(options.output, std::ios::binary);
+    if (!output) {
+        std::cerr << "drawc: cannot write " << options.output << "\n";
+        return 2;
+    }
+
+    if (!options.text) {
+        writeBinaryDrawing(output, drawing);
+        return output ? 0 : 2;
+    }
+
+    std::vector<uint32_t> offsets;
+    writeTextDrawing(output, drawing, &offsets);
+
+    char indexPath[256];
+    RobusDraw::indexPathFor(options.output.c_str(), indexPath, sizeof(indexPath));
+    std::ofstream index(indexPath, std::ios::binary);
+    if (!index) {
+        std::cerr << "drawc: cannot write " << indexPath << "\n";
+        return 2;
+    }
+    writeIndex(index, drawing, offsets, output.tellp());
+
+    return output && index ? 0 : 2;
+}